@@ -4,7 +4,7 @@
 #
 #-------------------------------------------------
 
-QT       += core gui xml
+QT       += core gui xml concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -29,8 +29,13 @@ linux {
 SOURCES += \
     src/CinderBlock.cpp \
     src/CinderBlockManager.cpp \
+    src/CompiledTemplate.cpp \
+    src/CopyPlan.cpp \
+    src/DirListingCache.cpp \
     src/ErrorList.cpp \
+    src/ErrorListDialog.cpp \
     src/FirstTimeDlg.cpp \
+    src/GenerationPlan.cpp \
     src/GeneratorVc2015.cpp \
     src/GeneratorVcBase.cpp \
     src/GeneratorXcodeBase.cpp \
@@ -39,13 +44,22 @@ SOURCES += \
     src/Instancer.cpp \
     src/main.cpp \
     src/MainWizard.cpp \
+    src/ManifestWatcher.cpp \
     src/Preferences.cpp \
+    src/PrefsDlg.cpp \
     src/ProjectTemplate.cpp \
     src/ProjectTemplateManager.cpp \
+    src/StringPool.cpp \
     src/Template.cpp \
+    src/TemplateCache.cpp \
+    src/TemplateStream.cpp \
+    src/TokenReplacer.cpp \
+    src/Trace.cpp \
     src/Util.cpp \
+    src/UtilGui.cpp \
     src/WizardPageCinderBlocks.cpp \
     src/WizardPageMain.cpp \
+    src/XmlFile.cpp \
     src/parse/PList.cpp \
     src/parse/Vc2015WinRtProj.cpp \
     src/parse/Vc2015Proj.cpp \
@@ -58,8 +72,13 @@ SOURCES += \
 HEADERS  += \
     src/CinderBlock.h \
     src/CinderBlockManager.h \
+    src/CompiledTemplate.h \
+    src/CopyPlan.h \
+    src/DirListingCache.h \
     src/ErrorList.h \
+    src/ErrorListDialog.h \
     src/FirstTimeDlg.h \
+    src/GenerationPlan.h \
     src/GeneratorBase.h \
     src/GeneratorVc2015Winrt.h \
     src/GeneratorVc2015.h \
@@ -69,14 +88,23 @@ HEADERS  += \
     src/GeneratorXcodeMac.h \
     src/Instancer.h \
     src/MainWizard.h \
+    src/ManifestWatcher.h \
     src/Preferences.h \
+    src/PrefsDlg.h \
     src/ProjectTemplate.h \
     src/ProjectTemplateManager.h \
+    src/StringPool.h \
     src/Template.h \
+    src/TemplateCache.h \
+    src/TemplateStream.h \
     src/TinderBox.h \
+    src/TokenReplacer.h \
+    src/Trace.h \
     src/Util.h \
+    src/UtilGui.h \
     src/WizardPageCinderBlocks.h \
     src/WizardPageMain.h \
+    src/XmlFile.h \
     src/parse/PList.h \
     src/parse/Vc2015WinRtProj.h \
     src/parse/Vc2015Proj.h \
@@ -0,0 +1,323 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "BatchGenerator.h"
+#include "CinderBlockManager.h"
+#include "GeneratorVc2015.h"
+#include "GeneratorVc2015Winrt.h"
+#include "GeneratorXcodeIos.h"
+#include "GeneratorXcodeMac.h"
+#include "Instancer.h"
+#include "ProjectTemplateManager.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+namespace {
+
+class GenerateTask : public QRunnable {
+  public:
+	GenerateTask( Instancer *instancer, bool setupGit, BatchGenerator::Result *result )
+		: mInstancer( instancer ), mSetupGit( setupGit ), mResult( result )
+	{}
+
+	void run()
+	{
+		try {
+			mResult->mCopyStats = mInstancer->generate( mSetupGit );
+			mResult->mSucceeded = true;
+		}
+		catch( const TinderBoxExc &exc ) {
+			mResult->mMessage = exc.msg();
+		}
+		catch( const std::exception &exc ) {
+			mResult->mMessage = QString::fromUtf8( exc.what() );
+		}
+	}
+
+  private:
+	Instancer				*mInstancer;
+	bool					mSetupGit;
+	BatchGenerator::Result	*mResult;
+};
+
+CinderBlock* findCinderBlockById( QList<CinderBlock> *blocks, const QString &searchId )
+{
+	for( QList<CinderBlock>::Iterator blockIt = blocks->begin(); blockIt != blocks->end(); ++blockIt ) {
+		if( blockIt->getId().compare( searchId, Qt::CaseInsensitive ) == 0 )
+			return &(*blockIt);
+	}
+
+	return NULL;
+}
+
+} // anonymous namespace
+
+BatchGenerator::BatchGenerator()
+	: mJobCount( 0 ), mCompareContents( false ), mProjectsPerSecond( 0 )
+{
+}
+
+void BatchGenerator::loadManifest( const QString &manifestPath )
+{
+	QFile file( manifestPath );
+	if( ! file.open( QIODevice::ReadOnly ) )
+		throw TinderBoxExc( "Couldn't open batch manifest: " + manifestPath );
+
+	QJsonParseError parseError;
+	QJsonDocument doc = QJsonDocument::fromJson( file.readAll(), &parseError );
+	if( ( parseError.error != QJsonParseError::NoError ) || ( ! doc.isObject() ) )
+		throw TinderBoxExc( "Couldn't parse batch manifest " + manifestPath + ": " + parseError.errorString() );
+
+	// relative paths are relative to the manifest
+	const QDir manifestDir = QFileInfo( manifestPath ).absoluteDir();
+	const QJsonObject root = doc.object();
+	if( root.contains( "cinderPath" ) )
+		mCinderPath = manifestDir.absoluteFilePath( root["cinderPath"].toString() );
+	mOutputDir = manifestDir.absoluteFilePath( root["outputDir"].toString( "." ) );
+	if( root.contains( "jobs" ) )
+		mJobCount = root["jobs"].toInt();
+	if( root.contains( "compareContents" ) )
+		mCompareContents = root["compareContents"].toBool();
+
+	mProjects.clear();
+	const QJsonArray projects = root["projects"].toArray();
+	for( QJsonArray::ConstIterator projIt = projects.begin(); projIt != projects.end(); ++projIt ) {
+		const QJsonObject proj = (*projIt).toObject();
+		Project project;
+		project.mName = proj["name"].toString();
+		if( project.mName.isEmpty() )
+			throw TinderBoxExc( "Batch manifest lists a project without a name: " + manifestPath );
+		project.mNamePrefix = proj["namePrefix"].toString( project.mName );
+		project.mTemplateId = proj["template"].toString();
+		project.mOutputDir = proj.contains( "outputDir" ) ? manifestDir.absoluteFilePath( proj["outputDir"].toString() ) : mOutputDir;
+		project.mSetupGit = proj["git"].toBool( false );
+
+		const QJsonArray generators = proj["generators"].toArray();
+		for( QJsonArray::ConstIterator genIt = generators.begin(); genIt != generators.end(); ++genIt )
+			project.mGenerators.push_back( (*genIt).toObject() );
+
+		const QJsonArray blocks = proj["blocks"].toArray();
+		for( QJsonArray::ConstIterator blockIt = blocks.begin(); blockIt != blocks.end(); ++blockIt ) {
+			const QJsonObject block = (*blockIt).toObject();
+			project.mBlocks.push_back( qMakePair( block["id"].toString(), installTypeFromString( block["install"].toString( "copy" ) ) ) );
+		}
+
+		mProjects.push_back( project );
+	}
+}
+
+GeneratorBase* BatchGenerator::createGenerator( const QJsonObject &options )
+{
+	const QString type = options["type"].toString().toLower();
+	if( type == "xcode" )
+		return new GeneratorXcodeMac();
+	else if( type == "xcode_ios" )
+		return new GeneratorXcodeIos();
+	else if( type == "vc2015" ) {
+		GeneratorVc2015::Options vcOptions;
+		vcOptions.enableWin32( options["win32"].toBool( true ) );
+		vcOptions.enableX64( options["x64"].toBool( true ) );
+		vcOptions.enableDesktopGl( options["desktopGl"].toBool( true ) );
+		vcOptions.enableAngle( options["angle"].toBool( false ) );
+		return new GeneratorVc2015( vcOptions );
+	}
+	else if( type == "vc2015_uwp" ) {
+		GeneratorVc2015WinRt::Options vcOptions;
+		vcOptions.enableWin32( options["win32"].toBool( true ) );
+		vcOptions.enableX64( options["x64"].toBool( true ) );
+		vcOptions.enableArm( options["arm"].toBool( false ) );
+		return new GeneratorVc2015WinRt( vcOptions );
+	}
+
+	return NULL;
+}
+
+CinderBlock::InstallType BatchGenerator::installTypeFromString( const QString &str )
+{
+	if( str.compare( "reference", Qt::CaseInsensitive ) == 0 )
+		return CinderBlock::INSTALL_REFERENCE;
+	else if( str.compare( "git", Qt::CaseInsensitive ) == 0 || str.compare( "submodule", Qt::CaseInsensitive ) == 0 )
+		return CinderBlock::INSTALL_GIT_SUBMODULE;
+	else if( str.compare( "none", Qt::CaseInsensitive ) == 0 )
+		return CinderBlock::INSTALL_NONE;
+	return CinderBlock::INSTALL_COPY;
+}
+
+// Runs on the calling thread, so every block is parsed at most once before any project is generated
+QSharedPointer<Instancer> BatchGenerator::createInstancer( const Project &project, QList<CinderBlock> *blocks, int copyThreadCount )
+{
+	const ProjectTemplate *projectTmpl = NULL;
+	const QList<ProjectTemplate> &templates = ProjectTemplateManager::getTemplates();
+	for( QList<ProjectTemplate>::ConstIterator tmplIt = templates.begin(); tmplIt != templates.end(); ++tmplIt ) {
+		if( tmplIt->getId() == project.mTemplateId ) {
+			projectTmpl = &(*tmplIt);
+			break;
+		}
+	}
+	if( ! projectTmpl )
+		throw TinderBoxExc( "Unknown project template: " + project.mTemplateId );
+
+	QSharedPointer<Instancer> result( new Instancer( *projectTmpl ) );
+	result->setProjectName( project.mName );
+	result->setNamePrefix( project.mNamePrefix );
+	result->setBaseLocation( project.mOutputDir );
+	result->setCinderAbsolutePath( mCinderPath );
+	result->setCopyThreadCount( copyThreadCount );
+	result->setCompareContents( mCompareContents );
+
+	for( QList<QJsonObject>::ConstIterator genIt = project.mGenerators.begin(); genIt != project.mGenerators.end(); ++genIt ) {
+		GeneratorBase *generator = createGenerator( *genIt );
+		if( ! generator )
+			throw TinderBoxExc( "Unknown generator type: " + (*genIt)["type"].toString() );
+		result->addGenerator( generator );
+	}
+
+	// the listed blocks, then whatever they and the template require, the way the wizard selects them
+	QList<QPair<CinderBlock*,CinderBlock::InstallType> > installs;
+	QList<QString> requires = projectTmpl->getRequires();
+	for( QList<QPair<QString,CinderBlock::InstallType> >::ConstIterator blockIt = project.mBlocks.begin(); blockIt != project.mBlocks.end(); ++blockIt ) {
+		CinderBlock *block = findCinderBlockById( blocks, blockIt->first );
+		if( ! block )
+			throw TinderBoxExc( "Unknown CinderBlock: " + blockIt->first );
+		installs.push_back( qMakePair( block, blockIt->second ) );
+		requires += block->getRequires();
+	}
+	while( ! requires.isEmpty() ) {
+		CinderBlock *block = findCinderBlockById( blocks, requires.takeFirst() );
+		bool listed = false;
+		for( QList<QPair<CinderBlock*,CinderBlock::InstallType> >::ConstIterator installIt = installs.begin(); installIt != installs.end(); ++installIt )
+			listed = listed || ( installIt->first == block );
+		if( ( ! block ) || listed )
+			continue;
+		installs.push_back( qMakePair( block, block->isCore() ? CinderBlock::INSTALL_REFERENCE : CinderBlock::INSTALL_COPY ) );
+		requires += block->getRequires();
+	}
+
+	for( QList<QPair<CinderBlock*,CinderBlock::InstallType> >::ConstIterator installIt = installs.begin(); installIt != installs.end(); ++installIt ) {
+		if( installIt->second == CinderBlock::INSTALL_NONE )
+			continue;
+		installIt->first->ensureParsed( &mErrors );
+		CinderBlock block( *installIt->first );
+		block.setInstallType( installIt->second );
+		result->addCinderBlock( block );
+	}
+
+	return result;
+}
+
+QList<QSharedPointer<Instancer> > BatchGenerator::createInstancers( int copyThreadCount, QList<Result> *results )
+{
+	// one scan, backed by the template cache, serves every project
+	mErrors.clear();
+	ProjectTemplateManager::clear();
+	ProjectTemplateManager::setCinderDir( QDir( mCinderPath ), &mErrors );
+	CinderBlockManager::clear();
+	CinderBlockManager::scan( mCinderPath, &mErrors );
+	QList<CinderBlock> blocks = CinderBlockManager::getCinderBlocks();
+
+	QList<QSharedPointer<Instancer> > instancers;
+	for( QList<Project>::ConstIterator projIt = mProjects.begin(); projIt != mProjects.end(); ++projIt ) {
+		Result result;
+		result.mName = projIt->mName;
+		result.mSucceeded = false;
+		QSharedPointer<Instancer> instancer;
+		try {
+			instancer = createInstancer( *projIt, &blocks, copyThreadCount );
+		}
+		catch( const TinderBoxExc &exc ) {
+			result.mMessage = exc.msg();
+		}
+		results->push_back( result );
+		instancers.push_back( instancer );
+	}
+
+	return instancers;
+}
+
+QList<BatchGenerator::Result> BatchGenerator::run()
+{
+	const int jobCount = qMax( 1, ( mJobCount > 0 ) ? mJobCount : QThread::idealThreadCount() );
+	// split the cores between concurrent projects rather than giving each project a full pool of copy threads
+	const int copyThreadCount = qMax( 1, QThread::idealThreadCount() / jobCount );
+
+	QList<Result> results;
+	QList<QSharedPointer<Instancer> > instancers = createInstancers( copyThreadCount, &results );
+
+	// throughput covers generating only, not the scan
+	QElapsedTimer timer;
+	timer.start();
+
+	// each task writes only its own Result
+	QThreadPool pool;
+	pool.setMaxThreadCount( jobCount );
+	for( int p = 0; p < instancers.size(); ++p ) {
+		if( instancers[p] )
+			pool.start( new GenerateTask( instancers[p].data(), mProjects[p].mSetupGit, &results[p] ) );
+	}
+	pool.waitForDone();
+
+	const double seconds = timer.elapsed() / 1000.0;
+	int succeeded = 0;
+	for( QList<Result>::ConstIterator resultIt = results.constBegin(); resultIt != results.constEnd(); ++resultIt ) {
+		if( resultIt->mSucceeded )
+			++succeeded;
+	}
+	mProjectsPerSecond = ( seconds > 0 ) ? ( succeeded / seconds ) : 0;
+
+	return results;
+}
+
+QList<BatchGenerator::Result> BatchGenerator::plan( QJsonArray *plans )
+{
+	QList<Result> results;
+	QList<QSharedPointer<Instancer> > instancers = createInstancers( 0, &results );
+
+	// planning only stats the inputs, so there's nothing to gain from running projects concurrently
+	for( int p = 0; p < instancers.size(); ++p ) {
+		QJsonObject entry;
+		entry["name"] = mProjects[p].mName;
+		if( instancers[p] ) {
+			try {
+				entry["plan"] = instancers[p]->createPlan( mProjects[p].mSetupGit ).toJson();
+				results[p].mSucceeded = true;
+			}
+			catch( const TinderBoxExc &exc ) {
+				results[p].mMessage = exc.msg();
+			}
+			catch( const std::exception &exc ) {
+				results[p].mMessage = QString::fromUtf8( exc.what() );
+			}
+		}
+		if( ! results[p].mSucceeded )
+			entry["error"] = results[p].mMessage;
+		plans->append( entry );
+	}
+
+	return results;
+}
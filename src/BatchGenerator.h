@@ -0,0 +1,112 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+#include "CinderBlock.h"
+#include "ErrorList.h"
+#include "Util.h"
+
+class GeneratorBase;
+
+// Generates many projects from one JSON manifest, sharing a single scan of the Cinder tree's templates and blocks
+// and running independent projects concurrently. A manifest looks like:
+//	{
+//		"cinderPath": "/path/to/Cinder", "outputDir": "/path/to/output", "jobs": 8, "compareContents": false,
+//		"projects": [ {
+//			"name": "BasicApp", "template": "org.libcinder.apptemplates.basic", "git": false,
+//			"generators": [ { "type": "xcode" }, { "type": "vc2015", "x64": true, "angle": false } ],
+//			"blocks": [ { "id": "org.libcinder.box2d", "install": "copy" } ]
+//		} ]
+//	}
+// Per-project "outputDir" and "namePrefix" override the defaults (the manifest's "outputDir" and the project name).
+class BatchGenerator {
+  public:
+	BatchGenerator();
+
+	struct Project {
+		QString								mName, mNamePrefix;
+		QString								mTemplateId;
+		QString								mOutputDir;
+		bool								mSetupGit;
+		QList<QJsonObject>					mGenerators;
+		QList<QPair<QString,CinderBlock::InstallType> >	mBlocks;
+	};
+
+	struct Result {
+		QString		mName;
+		bool		mSucceeded;
+		QString		mMessage;
+		CopyStats	mCopyStats;
+	};
+
+	// throws TinderBoxExc if the manifest can't be read
+	void			loadManifest( const QString &manifestPath );
+
+	const QString&			getCinderPath() const { return mCinderPath; }
+	void					setCinderPath( const QString &cinderPath ) { mCinderPath = cinderPath; }
+	const QList<Project>&	getProjects() const { return mProjects; }
+	void					addProject( const Project &project ) { mProjects.push_back( project ); }
+
+	// 0 runs one project per core
+	int				getJobCount() const { return mJobCount; }
+	void			setJobCount( int jobCount ) { mJobCount = jobCount; }
+	// see Instancer::setCompareContents()
+	bool			getCompareContents() const { return mCompareContents; }
+	void			setCompareContents( bool compare ) { mCompareContents = compare; }
+
+	// Scans the Cinder tree once, then generates every project. Results are in manifest order.
+	QList<Result>	run();
+	// As run(), but only appends what each project's generate() would do to 'plans' (see Instancer::createPlan()),
+	// as { "name": ..., "plan": ... } or { "name": ..., "error": ... }; nothing is written
+	QList<Result>	plan( QJsonArray *plans );
+
+	// projects the last run() generated successfully per second of generating, excluding the scan
+	double			getProjectsPerSecond() const { return mProjectsPerSecond; }
+	// warnings and errors from scanning and parsing templates and blocks
+	const ErrorList&	getErrors() const { return mErrors; }
+
+	static GeneratorBase*	createGenerator( const QJsonObject &options );
+	static CinderBlock::InstallType	installTypeFromString( const QString &str );
+
+  private:
+	QSharedPointer<class Instancer>	createInstancer( const Project &project, QList<CinderBlock> *blocks, int copyThreadCount );
+	// scans the Cinder tree and sets up an Instancer per project, null where 'results' records why it couldn't be
+	QList<QSharedPointer<class Instancer> >	createInstancers( int copyThreadCount, QList<Result> *results );
+
+	QString			mCinderPath;
+	QString			mOutputDir;
+	QList<Project>	mProjects;
+	int				mJobCount;
+	bool			mCompareContents;
+	double			mProjectsPerSecond;
+	ErrorList		mErrors;
+};
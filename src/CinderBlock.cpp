@@ -22,9 +22,26 @@
 */
 
 #include "CinderBlock.h"
+#include "Trace.h"
+#include "XmlFile.h"
+
+#include <QUrl>
 
 CinderBlock::CinderBlock( const QString &dir, const pugi::xml_node &xml, ErrorList *errors )
-	: Template( dir, xml, errors ), mRequired( false ), mInstallType( INSTALL_NONE )
+	: Template( dir, xml, errors ), mBlockIndex( -1 ), mParsed( true ), mRequired( false ), mInstallType( INSTALL_NONE )
+{
+	readAttributes( xml );
+}
+
+CinderBlock::CinderBlock( const QString &dir, const pugi::xml_node &xml, const QString &xmlPath, int blockIndex )
+	: mXmlPath( xmlPath ), mBlockIndex( blockIndex ), mParsed( false ), mRequired( false ), mInstallType( INSTALL_NONE )
+{
+	mParentPath = dir;
+	parseHeader( xml );
+	readAttributes( xml );
+}
+
+void CinderBlock::readAttributes( const pugi::xml_node &xml )
 {
 	mAuthor = QString::fromUtf8( xml.attribute( "author" ).value() );
 	mGitUrl = QString::fromUtf8( xml.attribute( "git" ).value() );
@@ -34,3 +51,59 @@ CinderBlock::CinderBlock( const QString &dir, const pugi::xml_node &xml, ErrorLi
 	mLibraryUrl = QString::fromUtf8( xml.attribute( "library" ).value() );
 	mVersion = QString::fromUtf8( xml.attribute( "version" ).value() );
 }
+
+CinderBlock::CinderBlock( TemplateStreamReader &in )
+	: Template( in ), mRequired( false ), mInstallType( INSTALL_NONE )
+{
+	mXmlPath = in.readString();
+	mBlockIndex = in.readInt();
+	mParsed = in.readBool();
+	mAuthor = in.readString();
+	mGitUrl = in.readString();
+	mBlockUrl = in.readString();
+	mDescription = in.readString();
+	mLicense = in.readString();
+	mLibraryUrl = in.readString();
+	mVersion = in.readString();
+	mIconPath = in.readString();
+}
+
+// install type and required-ness are per-project choices and are not saved
+void CinderBlock::write( TemplateStreamWriter &out ) const
+{
+	Template::write( out );
+	out.writeString( mXmlPath );
+	out.writeInt( mBlockIndex );
+	out.writeBool( mParsed );
+	out.writeString( mAuthor );
+	out.writeString( mGitUrl );
+	out.writeString( mBlockUrl );
+	out.writeString( mDescription );
+	out.writeString( mLicense );
+	out.writeString( mLibraryUrl );
+	out.writeString( mVersion );
+	out.writeString( mIconPath );
+}
+
+void CinderBlock::ensureParsed( ErrorList *errors )
+{
+	if( mParsed )
+		return;
+	mParsed = true;
+	TBOX_TRACE_SCOPE( "CinderBlock::ensureParsed" );
+
+	errors->setActiveFilePath( QString( "<a href=\"" ) + QUrl::fromLocalFile( mXmlPath ).toString() + "\">" + mXmlPath + "</a>" );
+
+	XmlFile xml( mXmlPath );
+	pugi::xpath_node_set blocks;
+	if( xml.isLoaded() )
+		blocks = xml.getDocument().select_nodes( "/cinder/block" );
+	if( ! xml.isLoaded() )
+		errors->addError( xml.getErrorDescription(), mXmlPath );
+	else if( mBlockIndex < 0 || mBlockIndex >= (int)blocks.size() )
+		errors->addError( "CinderBlock \"" + mId + "\" is no longer present.", mXmlPath );
+	else
+		parseBody( blocks[mBlockIndex].node(), errors );
+
+	errors->setActiveFilePath( "" );
+}
@@ -33,6 +33,11 @@ class CinderBlock : public Template
 {
   public:
 	CinderBlock( const QString &dir, const pugi::xml_node &node, ErrorList *errors );
+	// Reads only the header of the 'blockIndex'th <block> of 'xmlPath'; the contents are parsed by ensureParsed()
+	CinderBlock( const QString &dir, const pugi::xml_node &node, const QString &xmlPath, int blockIndex );
+	explicit CinderBlock( TemplateStreamReader &in );
+
+	void				write( TemplateStreamWriter &out ) const;
 
 	typedef enum { INSTALL_NONE, INSTALL_COPY, INSTALL_REFERENCE, INSTALL_GIT_SUBMODULE } InstallType;
 
@@ -50,10 +55,16 @@ class CinderBlock : public Template
 	InstallType			getInstallType() const { return mInstallType; }
 	void				setInstallType( const InstallType installType ) { mInstallType = installType; }
 
+	// Parses the block's contents if only its header has been read so far. Items, files and paths are empty until then
+	void				ensureParsed( ErrorList *errors );
+	bool				isParsed() const { return mParsed; }
+
 	bool				isRequired() const { return mRequired; }
 	void				setRequired( bool required ) { mRequired = required; }
 
   protected:
+	void			readAttributes( const pugi::xml_node &xml );
+
 	QString			mAuthor;
 	QString			mGitUrl, mBlockUrl;
 	QString			mDescription;
@@ -61,6 +72,9 @@ class CinderBlock : public Template
 	QString			mLicense;
 	QString			mIconPath;
 	QString			mVersion;
+	QString			mXmlPath;
+	int				mBlockIndex;
+	bool			mParsed;
 	bool			mRequired;
 	InstallType		mInstallType;
 };
@@ -22,15 +22,18 @@
 */
 
 #include "CinderBlockManager.h"
+#include "Trace.h"
 #include "Util.h"
+#include "XmlFile.h"
 
-#include <QApplication>
 #include <QDir>
 #include <QFile>
+#include <QMap>
 #include <QUrl>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentMap>
 
 #include <iostream>
-#include <fstream>
 
 CinderBlockManager*	CinderBlockManager::inst()
 {
@@ -46,9 +49,20 @@ CinderBlockManager::CinderBlockManager()
 
 void CinderBlockManager::scan( const QString &path, ErrorList *errors )
 {
+	TBOX_TRACE_SCOPE( "CinderBlockManager::scan" );
 	QDir dir( path );
 	dir.setFilter( QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot );
-	inst()->scanAndParseCinderBlocks( dir, dir, 2, errors );
+	// one set of directory listings serves every file pattern of this scan
+	DirListingCache::Scope listingScope;
+
+	TemplateCache cache( "blocks", dir.absolutePath() );
+	cache.load();
+	{
+		TBOX_TRACE_SCOPE( "CinderBlockManager::scanAndParseCinderBlocks" );
+		inst()->scanAndParseCinderBlocks( dir, dir, 2, errors, &cache );
+	}
+	cache.save();
+	inst()->mWatchPaths = cache.getInputPaths();
 }
 
 CinderBlock* CinderBlockManager::findById( const QString &id )
@@ -64,78 +78,173 @@ void CinderBlockManager::clearInst()
 {
 	mCinderBlocks.clear();
 	mProjectTemplates.clear();
+	mWatchPaths.clear();
 }
 
-void CinderBlockManager::scanAndParseCinderBlocks( const QDir &cinderDir, const QDir &dir, int depth, ErrorList *errorList )
+namespace {
+// one cinderblock.xml or template.xml, either parsed on a worker thread or reused from the TemplateCache
+struct ParsedFile {
+	ParsedFile() : mReused( false ) {}
+
+	TemplateCache::Manifest	mManifest;
+	ErrorList				mErrors;
+	bool					mReused;
+};
+
+void parseBlockFile( const QString &cinderDirPath, ParsedFile *parsed )
 {
-	QFileInfoList list = dir.entryInfoList();
-	for (int i = 0; i < list.size(); ++i) {
-		QFileInfo fileInfo = list.at(i);
-		if( ( depth > 0 ) && fileInfo.isDir() ) {
-			QDir subDir( fileInfo.filePath() );
-			subDir.setFilter( QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot );
-			scanAndParseCinderBlocks( cinderDir, subDir, depth - 1, errorList );
+	TBOX_TRACE_SCOPE( "CinderBlockManager: parse cinderblock.xml" );
+	const QDir cinderDir( cinderDirPath ); // QDir caches lazily, so each thread gets its own
+	const QFileInfo fileInfo( parsed->mManifest.mPath );
+	const QDir dir = fileInfo.absoluteDir();
+	ErrorList *errorList = &parsed->mErrors;
+	TemplateCache::Manifest *manifest = &parsed->mManifest;
+
+	manifest->mStamp = TemplateCache::stamp( fileInfo.absoluteFilePath() );
+	XmlFile xml( fileInfo.absoluteFilePath() );
+	pugi::xml_document &doc = xml.getDocument();
+	manifest->mParsed = xml.isLoaded();
+	if( xml.isLoaded() ) {
+		pugi::xpath_node_set blocks = doc.select_nodes("/cinder/block");
+		for( pugi::xpath_node_set::const_iterator it = blocks.begin(); it != blocks.end(); ++it ) {
+			
+			QString relative = cinderDir.relativeFilePath( fileInfo.absoluteFilePath() );
+			errorList->setActiveFilePath( QString( "<a href=\"" ) + QUrl::fromLocalFile( fileInfo.absoluteFilePath() ).toString() + "\">" + relative + "</a>" );
+			
+			// only the header for now; see CinderBlock::ensureParsed()
+			manifest->mCinderBlocks.push_back( CinderBlock( dir.absolutePath(), it->node(), fileInfo.absoluteFilePath(), (int)( it - blocks.begin() ) ) );
 		}
-		else if( fileInfo.fileName() == "cinderblock.xml" ) {
-			std::ifstream fs( fileInfo.filePath().toStdString().c_str() );
-			pugi::xml_document doc;
-			pugi::xml_parse_result result = doc.load( fs );
-			if( result ) {
-				pugi::xpath_node_set blocks = doc.select_nodes("/cinder/block");
-				for( pugi::xpath_node_set::const_iterator it = blocks.begin(); it != blocks.end(); ++it ) {
-					
-					QString relative = cinderDir.relativeFilePath( fileInfo.absoluteFilePath() );
-					errorList->setActiveFilePath( QString( "<a href=\"" ) + QUrl::fromLocalFile( fileInfo.absoluteFilePath() ).toString() + "\">" + relative + "</a>" );
-					
-					mCinderBlocks.push_back( CinderBlock( dir.absolutePath(), it->node(), errorList ) );
-					
-					// does this block have any templates?
-					pugi::xpath_node_set templates = doc.select_nodes( "/cinder/template" );
-					for( pugi::xpath_node_set::const_iterator it = templates.begin(); it != templates.end(); ++it ) {
-						QFileInfo tmplPath( dir, it->node().first_child().value() );
-						if( tmplPath.exists() ) {
-							try {
-								QString relative = cinderDir.relativeFilePath( tmplPath.absoluteFilePath() );
-								errorList->setActiveFilePath( QString( "<a href=\"" ) + QUrl::fromLocalFile( tmplPath.absoluteFilePath() ).toString() + "\">" + relative + "</a>" );
-
-								pugi::xml_document doc;
-								std::ifstream fs( tmplPath.filePath().toStdString().c_str() );
-								pugi::xml_parse_result result = doc.load( fs );
-								if( result ) {
-									mProjectTemplates.push_back( ProjectTemplate( tmplPath.absoluteDir().absolutePath(),
-										doc.select_single_node( "cinder/template" ).node(), errorList ) );
-								}
-							}
-							catch( ... ) {}
-						}
-					}
-				}
-				
-				QFileInfo iconPath( dir, "cinderblock.png" );
-				if( iconPath.exists() ) {
-					mIconCache[iconPath.filePath()] = QIcon( iconPath.filePath() );
-					mCinderBlocks.back().setIconPath( iconPath.filePath() );
-				}
+
+		// templates belong to the document rather than to any one block
+		if( ! blocks.empty() ) {
+			pugi::xpath_node_set templates = doc.select_nodes( "/cinder/template" );
+			for( pugi::xpath_node_set::const_iterator it = templates.begin(); it != templates.end(); ++it ) {
+				QFileInfo tmplPath( dir, it->node().first_child().value() );
+				manifest->mTemplatePaths.push_back( tmplPath.absoluteFilePath() );
 			}
-			else {
-				//QString msg( "Error parsing CinderBlock:" + dir.relativeFilePath( fileInfo.filePath() ) );
-				//msg += QString(result.description());
-				errorList->addError( QString(result.description()), fileInfo.absoluteFilePath() );
-            }
 		}
+		
+		QFileInfo iconPath( dir, "cinderblock.png" );
+		TemplateCache::addDependency( manifest, iconPath.absoluteFilePath() );
+		if( iconPath.exists() )
+			manifest->mIconPath = iconPath.filePath();
+	}
+	else {
+		//QString msg( "Error parsing CinderBlock:" + dir.relativeFilePath( fileInfo.filePath() ) );
+		//msg += QString(result.description());
+		errorList->addError( xml.getErrorDescription(), fileInfo.absoluteFilePath() );
+	}
+	manifest->mMessages = parsed->mErrors.mMessages;
+}
+
+void parseTemplateFile( const QString &cinderDirPath, ParsedFile *parsed )
+{
+	TBOX_TRACE_SCOPE( "CinderBlockManager: parse template.xml" );
+	const QDir cinderDir( cinderDirPath );
+	const QFileInfo tmplPath( parsed->mManifest.mPath );
+	ErrorList *errorList = &parsed->mErrors;
+	try {
+		QString relative = cinderDir.relativeFilePath( tmplPath.absoluteFilePath() );
+		errorList->setActiveFilePath( QString( "<a href=\"" ) + QUrl::fromLocalFile( tmplPath.absoluteFilePath() ).toString() + "\">" + relative + "</a>" );
+
+		parsed->mManifest.mStamp = TemplateCache::stamp( tmplPath.absoluteFilePath() );
+		XmlFile xml( tmplPath.absoluteFilePath() );
+		parsed->mManifest.mParsed = xml.isLoaded();
+		if( xml.isLoaded() ) {
+			parsed->mManifest.mProjectTemplates.push_back( ProjectTemplate( tmplPath.absoluteDir().absolutePath(),
+				xml.getDocument().select_single_node( "cinder/template" ).node(), errorList ) );
+			TemplateCache::addPatternDependencies( &parsed->mManifest, parsed->mManifest.mProjectTemplates.back() );
+		}
+	}
+	catch( ... ) {}
+	parsed->mManifest.mMessages = parsed->mErrors.mMessages;
+}
+
+// reuses what it can from 'cache' and parses the rest on the global thread pool
+void parseFiles( QVector<ParsedFile> *files, const TemplateCache &cache, void (*parseFn)( const QString&, ParsedFile* ), const QString &cinderDirPath )
+{
+	QVector<ParsedFile*> toParse;
+	for( QVector<ParsedFile>::Iterator fileIt = files->begin(); fileIt != files->end(); ++fileIt ) {
+		fileIt->mReused = cache.findCurrent( fileIt->mManifest.mPath, &fileIt->mManifest );
+		if( ! fileIt->mReused )
+			toParse.append( &*fileIt );
+	}
+
+	QtConcurrent::blockingMap( toParse, [parseFn, &cinderDirPath]( ParsedFile *parsedFile ) { parseFn( cinderDirPath, parsedFile ); } );
+}
+} // anonymous namespace
+
+// Discovers every cinderblock.xml with the same walk the serial scan made (unless the TemplateCache shows the walk
+// would find the same files), then reuses or parses them and the templates they reference on the global thread pool,
+// and merges the results (and their error lists) back in discovery order
+void CinderBlockManager::scanAndParseCinderBlocks( const QDir &cinderDir, const QDir &dir, int depth, ErrorList *errorList, TemplateCache *cache )
+{
+	if( ! cache->reuseDiscovery() ) {
+		QStringList xmlPaths;
+		discoverCinderBlocks( dir, depth, &xmlPaths, cache );
+		cache->setDiscoveredPaths( xmlPaths );
+	}
+	const QStringList &xmlPaths = cache->getDiscoveredPaths();
+
+	QVector<ParsedFile> parsed( xmlPaths.size() );
+	for( int i = 0; i < xmlPaths.size(); ++i )
+		parsed[i].mManifest.mPath = xmlPaths[i];
+
+	const QString cinderDirPath = cinderDir.absolutePath();
+	parseFiles( &parsed, *cache, &parseBlockFile, cinderDirPath );
+
+	// each template file is parsed once, keyed by canonical path, and belongs to the first document that references it
+	QVector<ParsedFile> parsedTemplates;
+	QMap<QString,int> templateIndices;
+	QVector<QList<int> > templatesByFile( parsed.size() );
+	for( int i = 0; i < parsed.size(); ++i ) {
+		const QStringList &paths = parsed[i].mManifest.mTemplatePaths;
+		for( QStringList::ConstIterator pathIt = paths.begin(); pathIt != paths.end(); ++pathIt ) {
+			const QString canonicalPath = QFileInfo( *pathIt ).canonicalFilePath();
+			if( canonicalPath.isEmpty() || templateIndices.contains( canonicalPath ) ) // empty if it doesn't exist
+				continue;
+			templateIndices.insert( canonicalPath, parsedTemplates.size() );
+			templatesByFile[i].append( parsedTemplates.size() );
+			ParsedFile parsedTemplate;
+			parsedTemplate.mManifest.mPath = *pathIt;
+			parsedTemplates.append( parsedTemplate );
+		}
+	}
+
+	parseFiles( &parsedTemplates, *cache, &parseTemplateFile, cinderDirPath );
+
+	for( int i = 0; i < parsed.size(); ++i ) {
+		const TemplateCache::Manifest &manifest = parsed[i].mManifest;
+		cache->addManifest( manifest, parsed[i].mReused );
+		mCinderBlocks.append( manifest.mCinderBlocks );
+		errorList->mMessages.append( manifest.mMessages );
+		for( QList<int>::ConstIterator tmplIt = templatesByFile[i].begin(); tmplIt != templatesByFile[i].end(); ++tmplIt ) {
+			const ParsedFile &parsedTemplate = parsedTemplates[*tmplIt];
+			cache->addManifest( parsedTemplate.mManifest, parsedTemplate.mReused );
+			mProjectTemplates.append( parsedTemplate.mManifest.mProjectTemplates );
+			errorList->mMessages.append( parsedTemplate.mManifest.mMessages );
+		}
+		// as before, a file without blocks hands its icon to the previous file's last block
+		if( manifest.mParsed && ( ! manifest.mIconPath.isEmpty() ) && ( ! mCinderBlocks.isEmpty() ) )
+			mCinderBlocks.back().setIconPath( manifest.mIconPath );
 	}
 	
 	errorList->setActiveFilePath( "" );
 }
 
-const QIcon& CinderBlockManager::getIconInst( const QString &path )
+void CinderBlockManager::discoverCinderBlocks( const QDir &dir, int depth, QStringList *xmlPaths, TemplateCache *cache )
 {
-	static QIcon defaultIcon( ":/resources/GenericCinderBlock.png" );
-	if( path.isEmpty() ) {
-		return defaultIcon;
+	cache->addDir( dir.absolutePath() );
+	QFileInfoList list = dir.entryInfoList();
+	for (int i = 0; i < list.size(); ++i) {
+		QFileInfo fileInfo = list.at(i);
+		if( ( depth > 0 ) && fileInfo.isDir() ) {
+			QDir subDir( fileInfo.filePath() );
+			subDir.setFilter( QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot );
+			discoverCinderBlocks( subDir, depth - 1, xmlPaths, cache );
+		}
+		else if( fileInfo.fileName() == "cinderblock.xml" ) {
+			xmlPaths->append( fileInfo.absoluteFilePath() );
+		}
 	}
-	if( mIconCache.find( path ) != mIconCache.end() )
-		mIconCache[path] = QIcon( path );
-	
-	return mIconCache[path];
 }
@@ -27,31 +27,30 @@
 #include "CinderBlock.h"
 #include "ProjectTemplate.h"
 #include "ErrorList.h"
-
-#include <QIcon>
+#include "TemplateCache.h"
 
 class CinderBlockManager
 {
   public:
 	static const QList<CinderBlock>&		getCinderBlocks() { return inst()->mCinderBlocks; }
 	static const QList<ProjectTemplate>&	getProjectTemplates() { return inst()->mProjectTemplates; }
+	//! the directories and files the last scan was derived from; a change to any of them calls for a rescan
+	static const QStringList&				getWatchPaths() { return inst()->mWatchPaths; }
 	
 	//! add a directory to be scanned for CinderBlocks
 	static void		scan( const QString &path, ErrorList *errors );
 	static void		clear() { inst()->clearInst(); }
 	CinderBlock*	findById( const QString &id );
 
-	static const QIcon&	getIcon( const QString &path ) { return inst()->getIconInst( path ); }
-
   private:
 	static CinderBlockManager*	inst();
 	CinderBlockManager();
 
 	void	clearInst();
-	void	scanAndParseCinderBlocks( const QDir &cinderDir, const QDir &path, int depth, ErrorList *errorList );
-	const QIcon&	getIconInst( const QString &path );
+	void	scanAndParseCinderBlocks( const QDir &cinderDir, const QDir &path, int depth, ErrorList *errorList, TemplateCache *cache );
+	void	discoverCinderBlocks( const QDir &dir, int depth, QStringList *xmlPaths, TemplateCache *cache );
 
 	QList<CinderBlock>		mCinderBlocks;
 	QList<ProjectTemplate>	mProjectTemplates;
-	QMap<QString,QIcon>		mIconCache;
+	QStringList				mWatchPaths;
 };
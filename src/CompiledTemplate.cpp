@@ -0,0 +1,148 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "CompiledTemplate.h"
+#include "TinderBox.h"
+#include "TokenReplacer.h"
+
+#include <QFile>
+#include <QMap>
+#include <QMutex>
+#include <QTextStream>
+
+namespace {
+
+struct TokenSlot {
+	const char	*mToken;
+	int			mSlot;
+};
+
+const TokenSlot kTokenSlots[] = {
+	{ "_TBOX_PREFIX_", CompiledTemplate::SLOT_PREFIX },
+	{ "_TBOX_PROJECT_", CompiledTemplate::SLOT_PREFIX },
+	{ "_TBOX_CINDER_PATH_", CompiledTemplate::SLOT_CINDER_PATH }
+};
+const int kTokenSlotCount = sizeof( kTokenSlots ) / sizeof( kTokenSlots[0] );
+
+// matches the tokens above in order, so a match's token index is its entry in kTokenSlots
+TokenReplacer createSlotScanner()
+{
+	TokenReplacer result;
+	for( int t = 0; t < kTokenSlotCount; ++t )
+		result.setValue( kTokenSlots[t].mToken, QString() );
+	return result;
+}
+
+struct CacheEntry {
+	QDateTime								mLastModified;
+	qint64									mSize;
+	QSharedPointer<const CompiledTemplate>	mTemplate;
+};
+
+QMutex						sCacheMutex;
+QMap<QString,CacheEntry>	sCache;
+
+} // anonymous namespace
+
+QSharedPointer<const CompiledTemplate> CompiledTemplate::load( const QFileInfo &path )
+{
+	const QString absPath = path.absoluteFilePath();
+	const QFileInfo info( absPath ); // not 'path', whose attributes may be cached from earlier
+	const QDateTime lastModified = info.lastModified();
+	const qint64 size = info.size();
+
+	{
+		QMutexLocker lock( &sCacheMutex );
+		QMap<QString,CacheEntry>::ConstIterator cacheIt = sCache.constFind( absPath );
+		if( ( cacheIt != sCache.constEnd() ) && ( cacheIt->mLastModified == lastModified ) && ( cacheIt->mSize == size ) )
+			return cacheIt->mTemplate;
+	}
+
+	QFile srcFile( absPath );
+	if( ! srcFile.open( QFile::ReadOnly | QFile::Text ) ) {
+		throw GenerateFailed( "Couldn't open file for reading: " + absPath );
+	}
+
+	QTextStream srcStream( &srcFile );
+
+	srcStream.setAutoDetectUnicode( false );
+	srcStream.setCodec( "UTF-8" );
+
+	CacheEntry entry;
+	entry.mLastModified = lastModified;
+	entry.mSize = size;
+	entry.mTemplate = QSharedPointer<const CompiledTemplate>( new CompiledTemplate( srcStream.readAll() ) );
+
+	// a concurrent compile of the same file produces the same result, so the last one in simply wins
+	QMutexLocker lock( &sCacheMutex );
+	sCache.insert( absPath, entry );
+	return entry.mTemplate;
+}
+
+CompiledTemplate::CompiledTemplate( const QString &contents )
+	: mLiteralLength( 0 )
+{
+	for( int s = 0; s < SLOT_COUNT; ++s )
+		mSlotUses[s] = 0;
+
+	// the same scanner copyFile() replaces tokens with; tokens are ASCII, so UTF-8 is split only between characters
+	static const TokenReplacer sScanner = createSlotScanner();
+	const QByteArray utf8 = contents.toUtf8();
+	const char *end = utf8.constData() + utf8.size();
+
+	const char *literalStart = utf8.constData();
+	int tokenIndex, tokenLength;
+	for( const char *token = sScanner.findToken( literalStart, end, &tokenIndex, &tokenLength ); token < end; token = sScanner.findToken( literalStart, end, &tokenIndex, &tokenLength ) ) {
+		Segment segment;
+		segment.mLiteral = QString::fromUtf8( literalStart, (int)( token - literalStart ) );
+		segment.mSlot = kTokenSlots[tokenIndex].mSlot;
+		mSegments.append( segment );
+		mLiteralLength += segment.mLiteral.length();
+		++mSlotUses[segment.mSlot];
+
+		literalStart = token + tokenLength;
+	}
+
+	Segment tail;
+	tail.mLiteral = QString::fromUtf8( literalStart, (int)( end - literalStart ) );
+	tail.mSlot = -1;
+	mSegments.append( tail );
+	mLiteralLength += tail.mLiteral.length();
+}
+
+QString CompiledTemplate::instantiate( const QString values[SLOT_COUNT] ) const
+{
+	int length = mLiteralLength;
+	for( int s = 0; s < SLOT_COUNT; ++s )
+		length += mSlotUses[s] * values[s].length();
+
+	QString result;
+	result.reserve( length );
+	for( QList<Segment>::ConstIterator segmentIt = mSegments.begin(); segmentIt != mSegments.end(); ++segmentIt ) {
+		result.append( segmentIt->mLiteral );
+		if( segmentIt->mSlot >= 0 )
+			result.append( values[segmentIt->mSlot] );
+	}
+
+	return result;
+}
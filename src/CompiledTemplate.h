@@ -0,0 +1,56 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <QDateTime>
+#include <QFileInfo>
+#include <QList>
+#include <QSharedPointer>
+#include <QString>
+
+// A foundation text file split once into literal spans and token slots, so instantiating it for each generated
+// project is a single concatenation into a buffer of known size. Compiled files are shared between threads.
+class CompiledTemplate {
+  public:
+	typedef enum { SLOT_PREFIX, SLOT_CINDER_PATH, SLOT_COUNT } Slot; // _TBOX_PREFIX_ and _TBOX_PROJECT_ both fill SLOT_PREFIX
+
+	// The compiled form of 'path', compiled again only when the file's modification time or size changes. Throws GenerateFailed
+	static QSharedPointer<const CompiledTemplate>	load( const QFileInfo &path );
+
+	explicit CompiledTemplate( const QString &contents );
+
+	// 'values' is indexed by Slot
+	QString		instantiate( const QString values[SLOT_COUNT] ) const;
+
+  private:
+	// a literal span followed by a slot, or by nothing when mSlot is -1
+	struct Segment {
+		QString		mLiteral;
+		int			mSlot;
+	};
+
+	QList<Segment>	mSegments;
+	int				mLiteralLength;
+	int				mSlotUses[SLOT_COUNT];
+};
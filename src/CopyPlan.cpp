@@ -0,0 +1,172 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "CopyPlan.h"
+#include "Trace.h"
+#include "Util.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutex>
+#include <QRunnable>
+#include <QSharedPointer>
+#include <QThread>
+#include <QThreadPool>
+
+#include <algorithm>
+
+namespace {
+
+// the first failure of each group, by entry index, and the totals of everything copied; failures are cloned so that
+// they are rethrown as their own type
+struct CopyResults {
+	QMutex									mMutex;
+	QMap<int,QSharedPointer<QException> >	mErrors;
+	CopyStats								mStats;
+};
+
+// copies one group of entries in plan order; a failure abandons the rest of the group
+class CopyGroupTask : public QRunnable {
+  public:
+	CopyGroupTask( const QList<CopyPlan::Entry> &entries, const QList<int> &group, CopyResults *results )
+		: mEntries( entries ), mGroup( group ), mResults( results )
+	{}
+
+	void run()
+	{
+		TBOX_TRACE_SCOPE( "CopyPlan: copy group" );
+		CopyStats stats;
+		for( QList<int>::ConstIterator indexIt = mGroup.begin(); indexIt != mGroup.end(); ++indexIt ) {
+			const CopyPlan::Entry &entry = mEntries[*indexIt];
+			// nothing may escape a QRunnable, so anything else thrown is recorded as a GenerateFailed
+			QSharedPointer<QException> error;
+			try {
+				stats += copyFileOrDir( QFileInfo( entry.mSrcPath ), QFileInfo( entry.mDstPath ), entry.mOverwriteExisting,
+						entry.mReplaceContents, entry.mReplacePrefix, entry.mWindowsLineEndings, entry.mMode, entry.mCompareContents );
+			}
+			catch( const QException &exc ) {
+				error = QSharedPointer<QException>( exc.clone() );
+			}
+			catch( const std::exception &exc ) {
+				error = QSharedPointer<QException>( new GenerateFailed( "Unable to copy from " + entry.mSrcPath + " to " + entry.mDstPath + ": " + QString::fromLocal8Bit( exc.what() ) ) );
+			}
+			catch( ... ) {
+				error = QSharedPointer<QException>( new GenerateFailed( "Unable to copy from " + entry.mSrcPath + " to " + entry.mDstPath ) );
+			}
+			if( error ) {
+				QMutexLocker lock( &mResults->mMutex );
+				mResults->mErrors.insert( *indexIt, error );
+				mResults->mStats += stats;
+				return;
+			}
+		}
+
+		QMutexLocker lock( &mResults->mMutex );
+		mResults->mStats += stats;
+	}
+
+  private:
+	const QList<CopyPlan::Entry>	&mEntries;
+	QList<int>						mGroup;
+	CopyResults						*mResults;
+};
+
+// true if 'path' is 'dirPath' or lies inside it
+bool isSameOrInside( const QString &path, const QString &dirPath )
+{
+	return path.startsWith( dirPath ) && ( ( path.length() == dirPath.length() ) || ( path[dirPath.length()] == '/' ) );
+}
+
+} // anonymous namespace
+
+void CopyPlan::add( const QString &srcPath, const QString &dstPath, bool overwriteExisting, bool replaceContents,
+					const QString &replacePrefix, bool windowsLineEndings, CopyMode mode, bool compareContents )
+{
+	Entry entry;
+	entry.mSrcPath = QFileInfo( srcPath ).absoluteFilePath();
+	entry.mDstPath = QDir::cleanPath( QFileInfo( dstPath ).absoluteFilePath() );
+	entry.mOverwriteExisting = overwriteExisting;
+	entry.mReplaceContents = replaceContents;
+	entry.mReplacePrefix = replacePrefix;
+	entry.mWindowsLineEndings = windowsLineEndings;
+	entry.mMode = mode;
+	entry.mCompareContents = compareContents;
+	mEntries.push_back( entry );
+}
+
+// Each entry is keyed by the outermost directory copy containing its destination (or by its own destination),
+// so any two entries that could touch the same file end up in one group. Groups keep the plan's order.
+QList<QList<int> > CopyPlan::groupByDestination() const
+{
+	QStringList dirDestinations;
+	for( QList<Entry>::ConstIterator entryIt = mEntries.begin(); entryIt != mEntries.end(); ++entryIt ) {
+		if( QFileInfo( entryIt->mSrcPath ).isDir() )
+			dirDestinations.push_back( entryIt->mDstPath );
+	}
+	// shortest first, so the first containing directory found is the outermost
+	std::sort( dirDestinations.begin(), dirDestinations.end(), []( const QString &a, const QString &b ) { return a.length() < b.length(); } );
+
+	QList<QList<int> > result;
+	QMap<QString,int> groupIndices;
+	for( int i = 0; i < mEntries.size(); ++i ) {
+		QString key = mEntries[i].mDstPath;
+		for( QStringList::ConstIterator dirIt = dirDestinations.begin(); dirIt != dirDestinations.end(); ++dirIt ) {
+			if( isSameOrInside( mEntries[i].mDstPath, *dirIt ) ) {
+				key = *dirIt;
+				break;
+			}
+		}
+
+		QMap<QString,int>::ConstIterator groupIt = groupIndices.constFind( key );
+		if( groupIt == groupIndices.constEnd() ) {
+			groupIndices.insert( key, result.size() );
+			result.push_back( QList<int>() << i );
+		}
+		else
+			result[groupIt.value()].push_back( i );
+	}
+
+	return result;
+}
+
+CopyStats CopyPlan::execute( int maxThreads ) const
+{
+	if( mEntries.isEmpty() )
+		return CopyStats();
+
+	const QList<QList<int> > groups = groupByDestination();
+	CopyResults results;
+
+	QThreadPool pool;
+	pool.setMaxThreadCount( qMax( 1, qMin( ( maxThreads > 0 ) ? maxThreads : QThread::idealThreadCount(), groups.size() ) ) );
+	for( QList<QList<int> >::ConstIterator groupIt = groups.begin(); groupIt != groups.end(); ++groupIt )
+		pool.start( new CopyGroupTask( mEntries, *groupIt, &results ) );
+	pool.waitForDone();
+
+	// report the failure a serial copy would have hit first
+	if( ! results.mErrors.isEmpty() )
+		results.mErrors.first()->raise();
+
+	return results.mStats;
+}
@@ -0,0 +1,62 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <QList>
+#include <QString>
+
+#include "Util.h"
+
+// Records every copy a generate() will perform so they can be executed together on a bounded pool of threads.
+// Entries whose destinations overlap (the same path, or a path inside a directory being copied) run on one thread
+// in the order they were added, so that overwrite semantics match a serial copy.
+class CopyPlan {
+  public:
+	struct Entry {
+		QString		mSrcPath, mDstPath;
+		bool		mOverwriteExisting;
+		bool		mReplaceContents;
+		QString		mReplacePrefix;
+		bool		mWindowsLineEndings;
+		CopyMode	mMode;
+		bool		mCompareContents;
+	};
+
+	// mirrors the arguments of copyFileOrDir()
+	void		add( const QString &srcPath, const QString &dstPath, bool overwriteExisting, bool replaceContents = false,
+						const QString &replacePrefix = "", bool windowsLineEndings = false, CopyMode mode = COPY_MODE_COPY, bool compareContents = false );
+
+	const QList<Entry>&	getEntries() const { return mEntries; }
+	bool		isEmpty() const { return mEntries.isEmpty(); }
+	void		clear() { mEntries.clear(); }
+
+	// Performs every copy using at most 'maxThreads' threads, or QThread::idealThreadCount() when 'maxThreads' <= 0.
+	// If any copy fails, the error of the earliest failed entry is thrown once all work has finished.
+	CopyStats	execute( int maxThreads ) const;
+
+  private:
+	QList<QList<int> >	groupByDestination() const;
+
+	QList<Entry>		mEntries;
+};
@@ -0,0 +1,175 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "DirListingCache.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QRegExp>
+
+static DirListingCache *sCurrentCache = NULL;
+
+DirListingCache::Scope::Scope()
+	: mPrevious( sCurrentCache ), mCache( NULL )
+{
+	if( ! mPrevious ) {
+		mCache = new DirListingCache;
+		sCurrentCache = mCache;
+	}
+}
+
+DirListingCache::Scope::~Scope()
+{
+	if( mCache ) {
+		sCurrentCache = mPrevious;
+		delete mCache;
+	}
+}
+
+DirListingCache* DirListingCache::current()
+{
+	return sCurrentCache;
+}
+
+DirListingCache::Listing DirListingCache::list( const QString &absPath )
+{
+	QString key = QDir::cleanPath( absPath );
+	{
+		QMutexLocker lock( &mMutex );
+		QMap<QString,Listing>::ConstIterator it = mListings.constFind( key );
+		if( it != mListings.constEnd() )
+			return it.value();
+	}
+
+	// list outside of the lock; when two threads race on the same directory the first listing stored wins
+	Listing listing;
+	QFileInfo info( key );
+	if( info.isDir() ) {
+		// stamped before reading, so an entry added meanwhile leaves the stamp older than the directory
+		listing.mExists = true;
+		listing.mModified = info.lastModified().toMSecsSinceEpoch();
+		QDir dir( key );
+		listing.mFiles = dir.entryList( QDir::Files | QDir::NoDotAndDotDot );
+		listing.mDirs = dir.entryList( QDir::Dirs | QDir::NoDotAndDotDot );
+	}
+
+	QMutexLocker lock( &mMutex );
+	QMap<QString,Listing>::ConstIterator it = mListings.constFind( key );
+	if( it != mListings.constEnd() )
+		return it.value();
+	mListings.insert( key, listing );
+	return listing;
+}
+
+// the root an absolute 'path' starts with: "/", "C:/" or "//server/share/"
+static QString absoluteRoot( const QString &path )
+{
+	int length = 1;
+	if( path.startsWith( "//" ) ) {
+		const int share = path.indexOf( '/', path.indexOf( '/', 2 ) + 1 );
+		length = ( share < 0 ) ? path.size() : share;
+	}
+	else if( ( path.size() >= 2 ) && ( path[1] == ':' ) )
+		length = 2;
+	QString result = path.left( length );
+	if( ! result.endsWith( '/' ) )
+		result += '/';
+	return result;
+}
+
+// 'name' inside the directory 'dirPath', which may be a root ending in '/'
+static QString childPath( const QString &dirPath, const QString &name )
+{
+	return dirPath.endsWith( '/' ) ? ( dirPath + name ) : ( dirPath + '/' + name );
+}
+
+QStringList DirListingCache::glob( const QString &rootPath, const QString &pattern, QStringList *listedPaths )
+{
+	const QString path = QDir::fromNativeSeparators( pattern );
+	QStringList segments = path.split( '/', QString::SkipEmptyParts );
+	segments.removeAll( "." );
+
+	// an absolute pattern is walked from its own root, and its matches keep that root as the baseline's did
+	QString absPath = QDir( rootPath ).absolutePath(), relPath;
+	if( QDir::isAbsolutePath( path ) ) {
+		absPath = relPath = absoluteRoot( path );
+		segments = path.mid( absPath.size() ).split( '/', QString::SkipEmptyParts );
+		segments.removeAll( "." );
+	}
+
+	QStringList result;
+	if( ! segments.isEmpty() )
+		globImpl( absPath, relPath, segments, 0, &result, listedPaths );
+	// repeated "**" segments can reach the same file more than once
+	result.removeDuplicates();
+	return result;
+}
+
+void DirListingCache::clear()
+{
+	QMutexLocker lock( &mMutex );
+	mListings.clear();
+}
+
+void DirListingCache::globImpl( const QString &absPath, const QString &relPath, const QStringList &segments, int segment, QStringList *result, QStringList *listedPaths )
+{
+	const QString &seg = segments[segment];
+	const bool last = ( segment == segments.size() - 1 );
+
+	if( seg == "**" ) {
+		if( listedPaths )
+			listedPaths->append( QDir::cleanPath( absPath ) );
+		Listing listing = list( absPath );
+		// a trailing "**" matches every file beneath this directory; otherwise try zero directories first
+		if( last ) {
+			for( QStringList::ConstIterator fileIt = listing.mFiles.constBegin(); fileIt != listing.mFiles.constEnd(); ++fileIt )
+				result->append( relPath + *fileIt );
+		}
+		else
+			globImpl( absPath, relPath, segments, segment + 1, result, listedPaths );
+		for( QStringList::ConstIterator dirIt = listing.mDirs.constBegin(); dirIt != listing.mDirs.constEnd(); ++dirIt )
+			globImpl( childPath( absPath, *dirIt ), relPath + *dirIt + '/', segments, segment, result, listedPaths );
+		return;
+	}
+
+	// literal directory names are walked directly without listing their parent
+	if( ( ! last ) && ( ! seg.contains( QRegExp( "[*?\\[]" ) ) ) ) {
+		globImpl( childPath( absPath, seg ), relPath + seg + '/', segments, segment + 1, result, listedPaths );
+		return;
+	}
+
+	QRegExp re( seg, Qt::CaseInsensitive, QRegExp::Wildcard );
+	if( listedPaths )
+		listedPaths->append( QDir::cleanPath( absPath ) );
+	Listing listing = list( absPath );
+	const QStringList &names = last ? listing.mFiles : listing.mDirs;
+	for( QStringList::ConstIterator nameIt = names.constBegin(); nameIt != names.constEnd(); ++nameIt ) {
+		if( ! re.exactMatch( *nameIt ) )
+			continue;
+		if( last )
+			result->append( relPath + *nameIt );
+		else
+			globImpl( childPath( absPath, *nameIt ), relPath + *nameIt + '/', segments, segment + 1, result, listedPaths );
+	}
+}
@@ -0,0 +1,73 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <QMap>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+
+// Caches directory listings for the duration of a scan so that every <sourcePattern> / <headerPattern>
+// of every Template walks a given directory at most once. Safe to share between threads.
+class DirListingCache {
+  public:
+	struct Listing {
+		Listing() : mExists( false ), mModified( 0 ) {}
+
+		bool			mExists;
+		qint64			mModified; // ms since the epoch, taken before the directory was read
+		QStringList		mFiles;
+		QStringList		mDirs;
+	};
+
+	// Installs a cache as the current one for its lifetime; nested scopes reuse the outermost cache
+	class Scope {
+	  public:
+		Scope();
+		~Scope();
+
+	  private:
+		DirListingCache		*mPrevious, *mCache;
+	};
+
+	// the cache of the innermost active Scope, or NULL outside of a scan
+	static DirListingCache*	current();
+
+	// Sorted names of the files and subdirectories of 'absPath'; empty if it does not exist
+	Listing			list( const QString &absPath );
+
+	// Expands a glob 'pattern' relative to 'rootPath'. Segments may contain the wildcards '*', '?' and '[...]',
+	// matched case-insensitively, and a segment of "**" matches zero or more directories. Returns paths relative
+	// to 'rootPath', files only, in directory order; an absolute pattern is walked from its own root and returns
+	// absolute paths. If 'listedPaths' is supplied, every directory the expansion listed is appended to it.
+	QStringList		glob( const QString &rootPath, const QString &pattern, QStringList *listedPaths = NULL );
+
+	void			clear();
+
+  private:
+	void			globImpl( const QString &absPath, const QString &relPath, const QStringList &segments, int segment, QStringList *result, QStringList *listedPaths );
+
+	QMutex						mMutex;
+	QMap<QString,Listing>		mListings;
+};
@@ -21,15 +21,11 @@
  POSSIBILITY OF SUCH DAMAGE.
 */
 
-#ifndef ERRORLISTDIALOG_H
-#define ERRORLISTDIALOG_H
+#ifndef ERRORLIST_H
+#define ERRORLIST_H
 
-#include <QDialog>
-#include <QListWidgetItem>
-
-namespace Ui {
-class ErrorListDialog;
-}
+#include <QList>
+#include <QString>
 
 class ErrorList {
   public:
@@ -55,23 +51,4 @@ class ErrorList {
 	QString				mActiveFilePath;
 };
 
-class ErrorListDialog : public QDialog
-{
-	Q_OBJECT
-	
-public:
-	explicit ErrorListDialog(QWidget *parent = 0);
-	~ErrorListDialog();
-	
-	void	show( const ErrorList &list );
-	
-private slots:
-	void on_okButton_clicked();
-	
-	void on_errorList_itemClicked(QListWidgetItem *item);
-	
-private:
-	Ui::ErrorListDialog *ui;
-};
-
-#endif // ERRORLISTDIALOG_H
+#endif // ERRORLIST_H
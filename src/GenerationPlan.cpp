@@ -0,0 +1,108 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "GenerationPlan.h"
+
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QJsonArray>
+
+GenerationPlan::GenerationPlan()
+	: mTotalBytes( 0 ), mTotalFileCount( 0 )
+{
+}
+
+void GenerationPlan::addCopies( const CopyPlan &plan )
+{
+	for( QList<CopyPlan::Entry>::ConstIterator entryIt = plan.getEntries().begin(); entryIt != plan.getEntries().end(); ++entryIt ) {
+		Copy copy;
+		copy.mSrcPath = entryIt->mSrcPath;
+		copy.mDstPath = entryIt->mDstPath;
+		copy.mOverwriteExisting = entryIt->mOverwriteExisting;
+		copy.mReplaceContents = entryIt->mReplaceContents;
+		copy.mMode = entryIt->mMode;
+		copy.mCompareContents = entryIt->mCompareContents;
+		copy.mBytes = 0;
+		copy.mFileCount = 0;
+
+		QFileInfo srcInfo( copy.mSrcPath );
+		if( srcInfo.isDir() ) {
+			QDirIterator dirIt( copy.mSrcPath, QDir::Files | QDir::Hidden, QDirIterator::Subdirectories );
+			while( dirIt.hasNext() ) {
+				dirIt.next();
+				copy.mBytes += dirIt.fileInfo().size();
+				++copy.mFileCount;
+			}
+		}
+		else if( srcInfo.exists() ) {
+			copy.mBytes = srcInfo.size();
+			copy.mFileCount = 1;
+		}
+
+		mTotalBytes += copy.mBytes;
+		mTotalFileCount += copy.mFileCount;
+		mCopies.push_back( copy );
+	}
+}
+
+void GenerationPlan::addGitOperation( const QString &workingDir, const QStringList &arguments )
+{
+	GitOperation operation;
+	operation.mWorkingDir = workingDir;
+	operation.mArguments = arguments;
+	mGitOperations.push_back( operation );
+}
+
+QJsonObject GenerationPlan::toJson() const
+{
+	QJsonArray copies;
+	for( QList<Copy>::ConstIterator copyIt = mCopies.begin(); copyIt != mCopies.end(); ++copyIt ) {
+		QJsonObject copy;
+		copy["src"] = copyIt->mSrcPath;
+		copy["dst"] = copyIt->mDstPath;
+		copy["bytes"] = (double)copyIt->mBytes;
+		copy["files"] = copyIt->mFileCount;
+		copy["replaceContents"] = copyIt->mReplaceContents;
+		copy["overwrite"] = copyIt->mOverwriteExisting;
+		copy["mode"] = copyModeToString( copyIt->mMode );
+		copy["compareContents"] = copyIt->mCompareContents;
+		copies.append( copy );
+	}
+
+	QJsonArray gitOperations;
+	for( QList<GitOperation>::ConstIterator gitIt = mGitOperations.begin(); gitIt != mGitOperations.end(); ++gitIt ) {
+		QJsonObject operation;
+		operation["cwd"] = gitIt->mWorkingDir;
+		operation["args"] = QJsonArray::fromStringList( gitIt->mArguments );
+		gitOperations.append( operation );
+	}
+
+	QJsonObject result;
+	result["outputPath"] = mOutputPath;
+	result["totalBytes"] = (double)mTotalBytes;
+	result["totalFiles"] = mTotalFileCount;
+	result["copies"] = copies;
+	result["generatedFiles"] = QJsonArray::fromStringList( mGeneratedFiles );
+	result["git"] = gitOperations;
+	return result;
+}
@@ -0,0 +1,77 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "CopyPlan.h"
+
+// What Instancer::generate() would do, as computed by Instancer::createPlan() without touching the disk beyond
+// stat calls: every copy with its size, every file the generators write, and every git command.
+class GenerationPlan {
+  public:
+	GenerationPlan();
+
+	struct Copy {
+		QString		mSrcPath, mDstPath;
+		bool		mOverwriteExisting, mReplaceContents;
+		CopyMode	mMode;
+		bool		mCompareContents;
+		qint64		mBytes;
+		int			mFileCount; // more than one when copying a directory
+	};
+
+	struct GitOperation {
+		QString		mWorkingDir;
+		QStringList	mArguments;
+	};
+
+	void		setOutputPath( const QString &outputPath ) { mOutputPath = outputPath; }
+	QString		getOutputPath() const { return mOutputPath; }
+
+	// stats the source of every entry of 'plan'
+	void		addCopies( const CopyPlan &plan );
+	void		addGeneratedFile( const QString &absPath ) { mGeneratedFiles.push_back( absPath ); }
+	void		addGitOperation( const QString &workingDir, const QStringList &arguments );
+
+	const QList<Copy>&			getCopies() const { return mCopies; }
+	const QStringList&			getGeneratedFiles() const { return mGeneratedFiles; }
+	const QList<GitOperation>&	getGitOperations() const { return mGitOperations; }
+
+	qint64		getTotalBytes() const { return mTotalBytes; }
+	int			getTotalFileCount() const { return mTotalFileCount; }
+
+	QJsonObject	toJson() const;
+
+  private:
+	QString					mOutputPath;
+	QList<Copy>				mCopies;
+	QStringList				mGeneratedFiles;
+	QList<GitOperation>		mGitOperations;
+	qint64					mTotalBytes;
+	int						mTotalFileCount;
+};
@@ -33,8 +33,12 @@ class GeneratorBase {
 	GeneratorBase() {}
 	virtual ~GeneratorBase() {}
 
-    virtual QMap<QString,QString>   getConditions() const = 0;
+	virtual QMap<QString,QString>	getConditions() const = 0;
+	// every set of conditions generate() queries the Instancer with, so they can be resolved in one pass beforehand
+	virtual QList<QMap<QString,QString> >	getQueryConditions() const { return QList<QMap<QString,QString> >() << getConditions(); }
 	virtual void    generate( class Instancer *master ) = 0;
+	// the files generate() writes, relative to the project's output directory
+	virtual QStringList	getOutputPaths( const class Instancer *master ) const = 0;
 };
 
 typedef QSharedPointer<GeneratorBase>	GeneratorBaseRef;
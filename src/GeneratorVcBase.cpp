@@ -23,6 +23,7 @@
 
 #include "GeneratorVcBase.h"
 #include "ProjectTemplateManager.h"
+#include "Trace.h"
 #include "Util.h"
 #include "VcProj.h"
 
@@ -33,32 +34,60 @@ GeneratorVcBase::GeneratorVcBase( const QString &foundationName )
 {
 }
 
+// see VcProj::write()
+QStringList GeneratorVcBase::getOutputPaths( const Instancer *master ) const
+{
+	QStringList result;
+	result << mFoundationName + '/' + master->getNamePrefix() + ".vcxproj";
+	result << mFoundationName + '/' + master->getNamePrefix() + ".vcxproj.filters";
+	result << mFoundationName + '/' + master->getNamePrefix() + ".sln";
+	if( getUseRcFile() )
+		result << mFoundationName + "/Resources.rc";
+	return result;
+}
+
+// files are gathered for every config at once; everything else per platform configuration
+QList<QMap<QString,QString> > GeneratorVcBase::getQueryConditions() const
+{
+	QList<QMap<QString,QString> > result;
+	QMap<QString,QString> conditions = getConditions();
+	conditions["config"] = "*";
+	result.push_back( conditions );
+
+	auto projectConfigurations = getPlatformConfigurations();
+	for( auto configIt = projectConfigurations.begin(); configIt != projectConfigurations.end(); ++configIt )
+		result.push_back( configIt->getConditions() );
+
+	return result;
+}
+
 void GeneratorVcBase::setupIncludePaths( VcProjRef proj, Instancer *master, const VcProj::ProjectConfiguration &config, const QString &absPath, const QString &cinderPath )
 {
-	QList<Template::IncludePath> includePaths = master->getIncludePathsMatchingConditions( config.getConditions() );
-	for( QList<Template::IncludePath>::ConstIterator pathIt = includePaths.begin(); pathIt != includePaths.end(); ++pathIt )
-		proj->addHeaderPath( config, pathIt->getWinOutputPathRelativeTo( absPath, cinderPath ) );
+	Template::ItemRefs<Template::IncludePath> includePaths = master->getIncludePathsMatchingConditions( config.getConditions() );
+	for( Template::ItemRefs<Template::IncludePath>::ConstIterator pathIt = includePaths.begin(); pathIt != includePaths.end(); ++pathIt )
+		proj->addHeaderPath( config, (*pathIt)->getWinOutputPathRelativeTo( absPath, cinderPath ) );
 }
 
 void GeneratorVcBase::setupLibraryPaths( VcProjRef proj, Instancer *master, const VcProj::ProjectConfiguration &config, const QString &absPath, const QString &cinderPath )
 {
-	QList<Template::LibraryPath> libraryPaths = master->getLibraryPathsMatchingConditions( config.getConditions() );
-	for( QList<Template::LibraryPath>::ConstIterator pathIt = libraryPaths.begin(); pathIt != libraryPaths.end(); ++pathIt )
-		proj->addLibraryPath( config, pathIt->getWinOutputPathRelativeTo( absPath, cinderPath ) );
+	Template::ItemRefs<Template::LibraryPath> libraryPaths = master->getLibraryPathsMatchingConditions( config.getConditions() );
+	for( Template::ItemRefs<Template::LibraryPath>::ConstIterator pathIt = libraryPaths.begin(); pathIt != libraryPaths.end(); ++pathIt )
+		proj->addLibraryPath( config, (*pathIt)->getWinOutputPathRelativeTo( absPath, cinderPath ) );
 }
 
 void GeneratorVcBase::setupPreprocessorDefines( VcProjRef proj, Instancer *master, const VcProj::ProjectConfiguration &config )
 {
-	QList<Template::PreprocessorDefine> preprocessorDefines = master->getPreprocessorDefinesMatchingConditions( config.getConditions() );
-	for( QList<Template::PreprocessorDefine>::ConstIterator defineIt = preprocessorDefines.begin(); defineIt != preprocessorDefines.end(); ++defineIt )
-		proj->addPreprocessorDefine( config, defineIt->getValue() );
+	Template::ItemRefs<Template::PreprocessorDefine> preprocessorDefines = master->getPreprocessorDefinesMatchingConditions( config.getConditions() );
+	for( Template::ItemRefs<Template::PreprocessorDefine>::ConstIterator defineIt = preprocessorDefines.begin(); defineIt != preprocessorDefines.end(); ++defineIt )
+		proj->addPreprocessorDefine( config, (*defineIt)->getValue() );
 }
 
 void GeneratorVcBase::generate( Instancer *master )
 {
+	TBOX_TRACE_SCOPE( "GeneratorVcBase::generate" );
 	QMap<QString,QString> conditions = getConditions();
 	conditions["config"] = "*";
-	QList<Template::File> files = master->getFilesMatchingConditions( conditions );
+	Template::ItemRefs<Template::File> files = master->getFilesMatchingConditions( conditions );
 
 	auto projectConfigurations = getPlatformConfigurations();
 
@@ -75,34 +104,34 @@ void GeneratorVcBase::generate( Instancer *master )
     vcProj->setupNew( master->getNamePrefix(), getPlatformConfigurations(), getSlnDeploy(), getUseRcFile() );
 
 	for( const auto &config : projectConfigurations ) {
-		QList<Template::OutputExtension> outExtensions = master->getOutputExtensionsMatchingConditions( config.getConditions() );
+		Template::ItemRefs<Template::OutputExtension> outExtensions = master->getOutputExtensionsMatchingConditions( config.getConditions() );
 		if( ! outExtensions.empty() )
-			vcProj->setTargetExtension( config, outExtensions.first().getValue() );
+			vcProj->setTargetExtension( config, outExtensions.first()->getValue() );
 
 		setupIncludePaths( vcProj, master, config, absDirPath, cinderPath );
 		setupLibraryPaths( vcProj, master, config, absDirPath, cinderPath );
 		setupPreprocessorDefines( vcProj, master, config );
 
 		// setup static libraries
-		QList<Template::StaticLibrary> staticLibraries = master->getStaticLibrariesMatchingConditions( config.getConditions() );
-		for( QList<Template::StaticLibrary>::ConstIterator pathIt = staticLibraries.begin(); pathIt != staticLibraries.end(); ++pathIt )
-			vcProj->addStaticLibrary( config, pathIt->getWinOutputPathRelativeTo( absDirPath, cinderPath ) );
+		Template::ItemRefs<Template::StaticLibrary> staticLibraries = master->getStaticLibrariesMatchingConditions( config.getConditions() );
+		for( Template::ItemRefs<Template::StaticLibrary>::ConstIterator pathIt = staticLibraries.begin(); pathIt != staticLibraries.end(); ++pathIt )
+			vcProj->addStaticLibrary( config, (*pathIt)->getWinOutputPathRelativeTo( absDirPath, cinderPath ) );
 	}
 
 	// There is nothing to do for Dynamic libraries in VC so just ignore them.
 
 	// Iterate the Files.
-	for( QList<Template::File>::ConstIterator fileIt = files.begin(); fileIt != files.end(); ++fileIt ) {
-		if( fileIt->getType() == Template::File::SOURCE )
-			vcProj->addSourceFile( fileIt->getWinOutputPathRelativeTo( absDirPath, cinderPath ), fileIt->getVirtualPath() );
-		else if( fileIt->getType() == Template::File::HEADER )
-			vcProj->addHeaderFile( fileIt->getWinOutputPathRelativeTo( absDirPath, cinderPath ), fileIt->getVirtualPath(), fileIt->isResourceHeader() );
-		else if( fileIt->getType() == Template::File::RESOURCE )
-			vcProj->addResourceFile( fileIt->getResourceName(), fileIt->getWinOutputPathRelativeTo( absDirPath, cinderPath ), fileIt->getResourceType(), fileIt->getResourceId() );
-		else if( fileIt->getType() == Template::File::BUILD_COPY ) {
+	for( Template::ItemRefs<Template::File>::ConstIterator fileIt = files.begin(); fileIt != files.end(); ++fileIt ) {
+		if( (*fileIt)->getType() == Template::File::SOURCE )
+			vcProj->addSourceFile( (*fileIt)->getWinOutputPathRelativeTo( absDirPath, cinderPath ), (*fileIt)->getVirtualPath() );
+		else if( (*fileIt)->getType() == Template::File::HEADER )
+			vcProj->addHeaderFile( (*fileIt)->getWinOutputPathRelativeTo( absDirPath, cinderPath ), (*fileIt)->getVirtualPath(), (*fileIt)->isResourceHeader() );
+		else if( (*fileIt)->getType() == Template::File::RESOURCE )
+			vcProj->addResourceFile( (*fileIt)->getResourceName(), (*fileIt)->getWinOutputPathRelativeTo( absDirPath, cinderPath ), (*fileIt)->getResourceType(), (*fileIt)->getResourceId() );
+		else if( (*fileIt)->getType() == Template::File::BUILD_COPY ) {
 			for( const auto &config : projectConfigurations ) {
-				if( fileIt->conditionsMatch( config.getConditions() ) )
-					vcProj->addBuildCopy( config, fileIt->getWinOutputPathRelativeTo( absDirPath, cinderPath ) );
+				if( (*fileIt)->conditionsMatch( config.getConditions() ) )
+					vcProj->addBuildCopy( config, (*fileIt)->getWinOutputPathRelativeTo( absDirPath, cinderPath ) );
 			}
 		}
 	}
@@ -41,8 +41,10 @@ class GeneratorVcBase : public GeneratorBase {
 	virtual std::vector<VcProj::ProjectConfiguration>	getPlatformConfigurations() const = 0;
 	virtual bool                                        getSlnDeploy() const = 0;
 	virtual bool                                        getUseRcFile() const = 0;
+	virtual QList<QMap<QString,QString> >               getQueryConditions() const;
 
 	virtual void					generate( Instancer *master );
+	virtual QStringList				getOutputPaths( const Instancer *master ) const;
   protected:
 	virtual VcProjRef				createVcProj( const QString &vcProj, const QString &vcProjFilters ) = 0;
 
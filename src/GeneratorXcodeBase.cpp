@@ -3,6 +3,7 @@
 #include "Util.h"
 #include "XCodeProj.h"
 #include "ProjectTemplateManager.h"
+#include "Trace.h"
 
 #include <QDir>
 #include <iostream>
@@ -18,18 +19,18 @@ QString realXcodeSdkName( const QString &templateXmlName )
 }
 
 template<typename T>
-QList<QString> GeneratorXcodeBase::getUniqueSdks( Instancer *master, QList<T> (Instancer::*fn)( const QMap<QString,QString> & ) const, const QMap<QString,QString> &conditions )
+QList<QString> GeneratorXcodeBase::getUniqueSdks( Instancer *master, Template::ItemRefs<T> (Instancer::*fn)( const QMap<QString,QString> & ) const, const QMap<QString,QString> &conditions )
 {
 	QList<QString> sdks = getSdks();
 	if( sdks.size() > 1 ) {
 		QMap<QString,QString> conditionsWithSdk = conditions;
 		conditionsWithSdk["sdk"] = sdks[0];
-		QList<T> base = (master->*fn)( conditionsWithSdk );
+		Template::ItemRefs<T> base = (master->*fn)( conditionsWithSdk );
 		bool foundUnequal = false;
 		for( int s = 1; s < sdks.size(); ++s ) {
 			conditionsWithSdk["sdk"] = sdks[s];
-			QList<T> thisList = (master->*fn)( conditionsWithSdk );
-			if( base != thisList )
+			Template::ItemRefs<T> thisList = (master->*fn)( conditionsWithSdk );
+			if( ! Template::itemRefsEqual<T>( base, thisList ) )
 				foundUnequal = true;
 		}
 		
@@ -50,12 +51,12 @@ void GeneratorXcodeBase::setupIncludePaths( XCodeProjRef xcodeProj, Instancer *m
 	for( QList<QString>::ConstIterator sdkIt = sdks.begin(); sdkIt != sdks.end(); ++sdkIt ) {
 		QMap<QString,QString> conditionsWithSdk = conditions;
 		conditionsWithSdk["sdk"] = *sdkIt;
-		QList<Template::IncludePath> includePaths = master->getIncludePathsMatchingConditions( conditionsWithSdk );
-		for( QList<Template::IncludePath>::ConstIterator pathIt = includePaths.begin(); pathIt != includePaths.end(); ++pathIt )
-			if( pathIt->isSystem() )
-				xcodeProj->addSystemHeaderPath( config, realXcodeSdkName( *sdkIt ), pathIt->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
+		Template::ItemRefs<Template::IncludePath> includePaths = master->getIncludePathsMatchingConditions( conditionsWithSdk );
+		for( Template::ItemRefs<Template::IncludePath>::ConstIterator pathIt = includePaths.begin(); pathIt != includePaths.end(); ++pathIt )
+			if( (*pathIt)->isSystem() )
+				xcodeProj->addSystemHeaderPath( config, realXcodeSdkName( *sdkIt ), (*pathIt)->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
 			else
-				xcodeProj->addUserHeaderPath( config, realXcodeSdkName( *sdkIt ), pathIt->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
+				xcodeProj->addUserHeaderPath( config, realXcodeSdkName( *sdkIt ), (*pathIt)->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
 	}
 }
 
@@ -67,9 +68,9 @@ void GeneratorXcodeBase::setupLibraryPaths( XCodeProjRef xcodeProj, Instancer *m
 	for( QList<QString>::ConstIterator sdkIt = sdks.begin(); sdkIt != sdks.end(); ++sdkIt ) {
 		QMap<QString,QString> conditionsWithSdk = conditions;
 		conditionsWithSdk["sdk"] = *sdkIt;
-		QList<Template::LibraryPath> includePaths = master->getLibraryPathsMatchingConditions( conditionsWithSdk );
-		for( QList<Template::LibraryPath>::ConstIterator pathIt = includePaths.begin(); pathIt != includePaths.end(); ++pathIt )
-			xcodeProj->addLibraryPath( config, realXcodeSdkName( *sdkIt ), pathIt->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
+		Template::ItemRefs<Template::LibraryPath> includePaths = master->getLibraryPathsMatchingConditions( conditionsWithSdk );
+		for( Template::ItemRefs<Template::LibraryPath>::ConstIterator pathIt = includePaths.begin(); pathIt != includePaths.end(); ++pathIt )
+			xcodeProj->addLibraryPath( config, realXcodeSdkName( *sdkIt ), (*pathIt)->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
 	}
 }
 
@@ -81,9 +82,9 @@ void GeneratorXcodeBase::setupFrameworkPaths( XCodeProjRef xcodeProj, Instancer
 	for( QList<QString>::ConstIterator sdkIt = sdks.begin(); sdkIt != sdks.end(); ++sdkIt ) {
 		QMap<QString,QString> conditionsWithSdk = conditions;
 		conditionsWithSdk["sdk"] = *sdkIt;
-		QList<Template::FrameworkPath> frameworkPaths = master->getFrameworkPathsMatchingConditions( conditionsWithSdk );
-		for( QList<Template::FrameworkPath>::ConstIterator pathIt = frameworkPaths.begin(); pathIt != frameworkPaths.end(); ++pathIt )
-			xcodeProj->addFrameworkPath( config, realXcodeSdkName( *sdkIt ), pathIt->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
+		Template::ItemRefs<Template::FrameworkPath> frameworkPaths = master->getFrameworkPathsMatchingConditions( conditionsWithSdk );
+		for( Template::ItemRefs<Template::FrameworkPath>::ConstIterator pathIt = frameworkPaths.begin(); pathIt != frameworkPaths.end(); ++pathIt )
+			xcodeProj->addFrameworkPath( config, realXcodeSdkName( *sdkIt ), (*pathIt)->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
 	}
 }
 
@@ -105,9 +106,9 @@ void GeneratorXcodeBase::setupStaticLibaries( XCodeProjRef xcodeProj, Instancer
 	for( QList<QString>::ConstIterator sdkIt = sdks.begin(); sdkIt != sdks.end(); ++sdkIt ) {
 		QMap<QString,QString> conditionsWithSdk = conditions;
 		conditionsWithSdk["sdk"] = *sdkIt;
-		QList<Template::StaticLibrary> libraryPaths = master->getStaticLibrariesMatchingConditions( conditionsWithSdk );
-		for( QList<Template::StaticLibrary>::ConstIterator pathIt = libraryPaths.begin(); pathIt != libraryPaths.end(); ++pathIt ) {
-			xcodeProj->addStaticLibrary( config, realXcodeSdkName( *sdkIt ), pathIt->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
+		Template::ItemRefs<Template::StaticLibrary> libraryPaths = master->getStaticLibrariesMatchingConditions( conditionsWithSdk );
+		for( Template::ItemRefs<Template::StaticLibrary>::ConstIterator pathIt = libraryPaths.begin(); pathIt != libraryPaths.end(); ++pathIt ) {
+			xcodeProj->addStaticLibrary( config, realXcodeSdkName( *sdkIt ), (*pathIt)->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
 		}
 	}
 }
@@ -120,9 +121,9 @@ void GeneratorXcodeBase::setupDynamicLibaries( XCodeProjRef xcodeProj, Instancer
 	for( QList<QString>::ConstIterator sdkIt = sdks.begin(); sdkIt != sdks.end(); ++sdkIt ) {
 		QMap<QString,QString> conditionsWithSdk = conditions;
 		conditionsWithSdk["sdk"] = *sdkIt;
-		QList<Template::DynamicLibrary> libraryPaths = master->getDynamicLibrariesMatchingConditions( conditionsWithSdk );
-		for( QList<Template::DynamicLibrary>::ConstIterator pathIt = libraryPaths.begin(); pathIt != libraryPaths.end(); ++pathIt ) {
-			xcodeProj->addDynamicLibrary( config, realXcodeSdkName( *sdkIt ), pathIt->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
+		Template::ItemRefs<Template::DynamicLibrary> libraryPaths = master->getDynamicLibrariesMatchingConditions( conditionsWithSdk );
+		for( Template::ItemRefs<Template::DynamicLibrary>::ConstIterator pathIt = libraryPaths.begin(); pathIt != libraryPaths.end(); ++pathIt ) {
+			xcodeProj->addDynamicLibrary( config, realXcodeSdkName( *sdkIt ), (*pathIt)->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ) );
 		}
 	}
 }
@@ -134,11 +135,11 @@ void GeneratorXcodeBase::setupBuildSettings( XCodeProjRef xcodeProj, Instancer *
 	for( QList<QString>::ConstIterator sdkIt = sdks.begin(); sdkIt != sdks.end(); ++sdkIt ) {
 		QMap<QString,QString> conditionsWithSdk = conditions;
 		conditionsWithSdk["sdk"] = *sdkIt;
-		QList<Template::BuildSetting> buildSettings = master->getBuildSettingsMatchingConditions( conditionsWithSdk );
-		for( QList<Template::BuildSetting>::ConstIterator settingIt = buildSettings.begin(); settingIt != buildSettings.end(); ++settingIt ) {
-			std::cout << "<" << qPrintable(settingIt->getKey()) << "," << qPrintable(settingIt->getValue()) << ">\n";
-			if( ! settingIt->getKey().isEmpty() )
-				xcodeProj->setBuildSetting( config, *sdkIt, settingIt->getKey(), settingIt->getValue(), true );
+		Template::ItemRefs<Template::BuildSetting> buildSettings = master->getBuildSettingsMatchingConditions( conditionsWithSdk );
+		for( Template::ItemRefs<Template::BuildSetting>::ConstIterator settingIt = buildSettings.begin(); settingIt != buildSettings.end(); ++settingIt ) {
+			std::cout << "<" << qPrintable((*settingIt)->getKey()) << "," << qPrintable((*settingIt)->getValue()) << ">\n";
+			if( ! (*settingIt)->getKey().isEmpty() )
+				xcodeProj->setBuildSetting( config, *sdkIt, (*settingIt)->getKey(), (*settingIt)->getValue(), true );
 		}
 	}
 }
@@ -150,9 +151,9 @@ void GeneratorXcodeBase::setupPreprocessorDefines( XCodeProjRef xcodeProj, Insta
 	for( QList<QString>::ConstIterator sdkIt = sdks.begin(); sdkIt != sdks.end(); ++sdkIt ) {
 		QMap<QString,QString> conditionsWithSdk = conditions;
 		conditionsWithSdk["sdk"] = *sdkIt;
-		QList<Template::PreprocessorDefine> defines = master->getPreprocessorDefinesMatchingConditions( conditionsWithSdk );
-		for( QList<Template::PreprocessorDefine>::ConstIterator defineIt = defines.begin(); defineIt != defines.end(); ++defineIt ) {
-			xcodeProj->addPreprocessorDefine( config, *sdkIt, defineIt->getValue() );
+		Template::ItemRefs<Template::PreprocessorDefine> defines = master->getPreprocessorDefinesMatchingConditions( conditionsWithSdk );
+		for( Template::ItemRefs<Template::PreprocessorDefine>::ConstIterator defineIt = defines.begin(); defineIt != defines.end(); ++defineIt ) {
+			xcodeProj->addPreprocessorDefine( config, *sdkIt, (*defineIt)->getValue() );
 		}
 	}
 }
@@ -164,18 +165,47 @@ void GeneratorXcodeBase::setupOutputExtension( XCodeProjRef xcodeProj, Instancer
 	for( QList<QString>::ConstIterator sdkIt = sdks.begin(); sdkIt != sdks.end(); ++sdkIt ) {
 		QMap<QString,QString> conditionsWithSdk = conditions;
 		conditionsWithSdk["sdk"] = *sdkIt;
-		QList<Template::OutputExtension> outputExtensions = master->getOutputExtensionsMatchingConditions( conditionsWithSdk );
+		Template::ItemRefs<Template::OutputExtension> outputExtensions = master->getOutputExtensionsMatchingConditions( conditionsWithSdk );
 		if( ! outputExtensions.empty() )
-			xcodeProj->setBuildSetting( config, *sdkIt, "WRAPPER_EXTENSION", outputExtensions.front().getValue(), true );
+			xcodeProj->setBuildSetting( config, *sdkIt, "WRAPPER_EXTENSION", outputExtensions.front()->getValue(), true );
 	}
 }
 
+QStringList GeneratorXcodeBase::getOutputPaths( const Instancer *master ) const
+{
+	return QStringList() << getRootFolderName() + '/' + master->getNamePrefix() + ".xcodeproj/project.pbxproj";
+}
+
+// the base conditions for files, then each config with every sdk and the "" sdk used when all sdks agree
+QList<QMap<QString,QString> > GeneratorXcodeBase::getQueryConditions() const
+{
+	QList<QMap<QString,QString> > result;
+	QMap<QString,QString> conditions = getConditions();
+	result.push_back( conditions );
+
+	QList<QString> sdks = getSdks();
+	sdks.push_back( QString( "" ) );
+	const char *configs[] = { "debug", "release" };
+	for( int c = 0; c < 2; ++c ) {
+		QMap<QString,QString> configConditions = conditions;
+		configConditions["config"] = configs[c];
+		result.push_back( configConditions );
+		for( QList<QString>::ConstIterator sdkIt = sdks.begin(); sdkIt != sdks.end(); ++sdkIt ) {
+			configConditions["sdk"] = *sdkIt;
+			result.push_back( configConditions );
+		}
+	}
+
+	return result;
+}
+
 void GeneratorXcodeBase::generate( Instancer *master )
 {
+	TBOX_TRACE_SCOPE( "GeneratorXcodeBase::generate" );
     QMap<QString,QString> conditions = getConditions();
     QMap<QString,QString> debugConditions = conditions; debugConditions["config"] = "debug";
     QMap<QString,QString> releaseConditions = conditions; releaseConditions["config"] = "release";
-    QList<Template::File> files = master->getFilesMatchingConditions( conditions );
+    Template::ItemRefs<Template::File> files = master->getFilesMatchingConditions( conditions );
 
 	// setup output paths of the project itself, and create its parent "xcode" directory
 	QString xcodeAbsPath = master->createDirectory( getRootFolderName() );
@@ -208,24 +238,24 @@ void GeneratorXcodeBase::generate( Instancer *master )
 	setupDynamicLibaries( xcodeProj, master, releaseConditions, "Release", xcodeAbsPath, cinderPath );
 	
 	// setup files
-    for( QList<Template::File>::ConstIterator fileIt = files.begin(); fileIt != files.end(); ++fileIt ) {
-		if( fileIt->getType() == Template::File::SOURCE )
-			xcodeProj->addSourceFile( fileIt->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ), fileIt->getVirtualPath(), fileIt->getCompileAs() );
-		else if( fileIt->getType() == Template::File::HEADER )
-			xcodeProj->addHeaderFile( fileIt->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ), fileIt->getVirtualPath() );
-		else if( fileIt->getType() == Template::File::RESOURCE )
-			xcodeProj->addResource( fileIt->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ),
-				fileIt->getVirtualPath(), fileIt->isOutputBuildExcluded() );
-		else if( fileIt->getType() == Template::File::FRAMEWORK )
-			xcodeProj->addFramework( fileIt->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ), fileIt->getVirtualPath(),
-				fileIt->isOutputAbsolute(), fileIt->isOutputSdkRelative() );
+    for( Template::ItemRefs<Template::File>::ConstIterator fileIt = files.begin(); fileIt != files.end(); ++fileIt ) {
+		if( (*fileIt)->getType() == Template::File::SOURCE )
+			xcodeProj->addSourceFile( (*fileIt)->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ), (*fileIt)->getVirtualPath(), (*fileIt)->getCompileAs() );
+		else if( (*fileIt)->getType() == Template::File::HEADER )
+			xcodeProj->addHeaderFile( (*fileIt)->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ), (*fileIt)->getVirtualPath() );
+		else if( (*fileIt)->getType() == Template::File::RESOURCE )
+			xcodeProj->addResource( (*fileIt)->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ),
+				(*fileIt)->getVirtualPath(), (*fileIt)->isOutputBuildExcluded() );
+		else if( (*fileIt)->getType() == Template::File::FRAMEWORK )
+			xcodeProj->addFramework( (*fileIt)->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ), (*fileIt)->getVirtualPath(),
+				(*fileIt)->isOutputAbsolute(), (*fileIt)->isOutputSdkRelative() );
 	}
 
 	// we process buildCopy's last so that we can try to reuse an existing fileref
-	for( QList<Template::File>::ConstIterator fileIt = files.begin(); fileIt != files.end(); ++fileIt ) {
-		if( fileIt->getType() == Template::File::BUILD_COPY )
-			xcodeProj->addBuildCopy( fileIt->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ), fileIt->getVirtualPath(),
-									 fileIt->isOutputAbsolute(), fileIt->isOutputSdkRelative(), fileIt->getBuildCopyDestination() );
+	for( Template::ItemRefs<Template::File>::ConstIterator fileIt = files.begin(); fileIt != files.end(); ++fileIt ) {
+		if( (*fileIt)->getType() == Template::File::BUILD_COPY )
+			xcodeProj->addBuildCopy( (*fileIt)->getMacOutputPathRelativeTo( xcodeAbsPath, cinderPath ), (*fileIt)->getVirtualPath(),
+									 (*fileIt)->isOutputAbsolute(), (*fileIt)->isOutputSdkRelative(), (*fileIt)->getBuildCopyDestination() );
 	}
 
 	// build settings
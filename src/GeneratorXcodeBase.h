@@ -35,7 +35,9 @@
 class GeneratorXcodeBase : public GeneratorBase {
   public:
 	virtual QMap<QString,QString>	getConditions() const = 0;
+	virtual QList<QMap<QString,QString> >	getQueryConditions() const;
 	virtual void					generate( Instancer *master );
+	virtual QStringList				getOutputPaths( const Instancer *master ) const;
 	virtual QString					getRootFolderName() const = 0;
 	
 	virtual QList<QString>			getSdks() const = 0;
@@ -56,5 +58,5 @@ class GeneratorXcodeBase : public GeneratorBase {
 	void	setupOutputExtension( XCodeProjRef xcodeProj, Instancer *master, const QMap<QString,QString> &conditions, const QString &config );
 								
 	template<typename T>
-	QList<QString> getUniqueSdks( Instancer *master, QList<T> (Instancer::*fn)( const QMap<QString,QString> & ) const, const QMap<QString,QString> &conditions );
+	QList<QString> getUniqueSdks( Instancer *master, Template::ItemRefs<T> (Instancer::*fn)( const QMap<QString,QString> & ) const, const QMap<QString,QString> &conditions );
 };
@@ -27,26 +27,91 @@
 #include "Util.h"
 #include "Instancer.h"
 #include "ProjectTemplateManager.h"
+#include "Trace.h"
 
 #include <QDir>
 #include <QFile>
+#include <QFuture>
+#include <QHash>
 #include <iostream>
+#include <QMutex>
 #include <QProcess>
-
-bool executeGitCommand( const QStringList &params )
-{
-std::cout << "Git: ";
-for( QStringList::ConstIterator sIt = params.begin(); sIt != params.end(); ++sIt )
-	std::cout << sIt->toStdString() << " ";
-std::cout << std::endl;
-#ifdef Q_OS_MAC
-	return QProcess::execute( Preferences::getGitPath(), params ) == 0;
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+
+// runs git in 'workingDir' rather than changing the process's current directory, so concurrent Instancers don't collide
+bool executeGitCommand( const QString &workingDir, const QStringList &params )
+{
+	{
+		static QMutex sEchoMutex; // keeps concurrent clones' echoes on separate lines
+		QMutexLocker lock( &sEchoMutex );
+		std::cout << "Git: ";
+		for( QStringList::ConstIterator sIt = params.begin(); sIt != params.end(); ++sIt )
+			std::cout << sIt->toStdString() << " ";
+		std::cout << std::endl;
+	}
+	QProcess process;
+	process.setWorkingDirectory( workingDir );
+	process.setProcessChannelMode( QProcess::ForwardedChannels );
+#if defined( Q_OS_WIN )
+	process.start( "cmd", QStringList() << "/c" << "git" << params );
 #else
-	return QProcess::execute( "cmd", QStringList() << "/c" << "git" << params ) == 0;
+	process.start( Preferences::getGitPath(), params );
 #endif
+	if( ! process.waitForFinished( -1 ) )
+		return false;
+	return ( process.exitStatus() == QProcess::NormalExit ) && ( process.exitCode() == 0 );
+}
+
+QString gitSubmoduleRelativePath( const CinderBlockRef &block )
+{
+	return QString::fromUtf8( "blocks" ) + QDir::separator() + block->getName();
+}
+
+// --shared borrows the objects of the block's local repository through .git/objects/info/alternates instead of copying them
+QStringList gitSubmoduleCloneParams( const CinderBlockRef &block )
+{
+	return QStringList() << "clone" << "--shared" << "--recursive" << QDir::toNativeSeparators( block->getParentPath() ) << gitSubmoduleRelativePath( block );
+}
+
+QStringList gitSubmodulesCommitParams( const QList<CinderBlockRef> &blocks )
+{
+	QStringList names;
+	for( QList<CinderBlockRef>::ConstIterator blockIt = blocks.begin(); blockIt != blocks.end(); ++blockIt )
+		names.append( (*blockIt)->getName() );
+	const QString noun = ( blocks.size() == 1 ) ? "submodule" : "submodules";
+	return QStringList() << "commit" << "-m" << ( "\"Adding " + names.join( ", " ) + " " + noun + "\"" );
 }
 
+// clones one block and points its origin at the block's public URL; clones write to disjoint directories so they can run side by side
+class GitCloneTask : public QRunnable {
+  public:
+	GitCloneTask( const QString &outputPath, const CinderBlockRef &block, bool *succeeded )
+		: mOutputPath( outputPath ), mBlock( block ), mSucceeded( succeeded )
+	{}
+
+	void run()
+	{
+		TBOX_TRACE_SCOPE( "Instancer: git clone" );
+		*mSucceeded = executeGitCommand( mOutputPath, gitSubmoduleCloneParams( mBlock ) )
+			&& executeGitCommand( mOutputPath + QDir::separator() + gitSubmoduleRelativePath( mBlock ), QStringList() << "remote" << "set-url" << "origin" << mBlock->getGitUrl() );
+	}
+
+  private:
+	QString			mOutputPath;
+	CinderBlockRef	mBlock;
+	bool			*mSucceeded;
+};
+
+} // anonymous namespace
+
 Instancer::Instancer( const ProjectTemplate &projectTmpl )
+	: mCopyThreadCount( 0 ), mBlockCopyMode( COPY_MODE_COPY ), mAssetCopyMode( COPY_MODE_COPY ), mCompareContents( false )
 {
 	if( projectTmpl.hasParentProject() ) {
 		mChildTemplate = QSharedPointer<ProjectTemplate>( new ProjectTemplate( projectTmpl ) );
@@ -56,20 +121,107 @@ Instancer::Instancer( const ProjectTemplate &projectTmpl )
 		mProjectTmpl = projectTmpl;
 }
 
-void Instancer::generate( bool setupGit )
+CopyStats Instancer::generate( bool setupGit )
 {
+	TBOX_TRACE_SCOPE( "Instancer::generate" );
+
 	if( ! prepareGenerate() )
-		return;
+		return CopyStats();
 
+	// plan every copy up front, in the order a serial copy would perform them
 	QList<QMap<QString,QString> > conditions;
+	CopyPlan copyPlan;
+	planGenerate( &conditions, &copyPlan );
+
+	// create the assets directory if necessary
+	if( ! QDir( getOutputDir().absolutePath() + "/assets/" ).exists() )
+		getOutputDir().mkdir( "assets" );
+
+	// git runs as its own stage alongside the copies and generators; submodule blocks are generated against
+	// their clone locations up front, and any block whose clone fails is regenerated against its input below
+	const QString outputPath = getOutputDir().absolutePath();
+	QList<CinderBlockRef> submoduleBlocks;
+	QFuture<QList<CinderBlockRef> > gitStage;
+	if( setupGit ) {
+		submoduleBlocks = getGitSubmoduleBlocks();
+		for( QList<CinderBlockRef>::ConstIterator blockIt = submoduleBlocks.begin(); blockIt != submoduleBlocks.end(); ++blockIt )
+			(*blockIt)->setOutputPath( outputPath + QDir::separator() + gitSubmoduleRelativePath( *blockIt ), getNamePrefix(), getCinderAbsolutePath() );
+		gitStage = QtConcurrent::run( this, &Instancer::setupGitStage, outputPath, submoduleBlocks );
+	}
+
+	CopyStats copyStats;
+	try {
+		{
+			TBOX_TRACE_SCOPE( "Instancer: copy files" );
+			copyStats = copyPlan.execute( mCopyThreadCount );
+		}
+
+		generateProjectFiles();
+	}
+	catch( ... ) {
+		gitStage.waitForFinished(); // the stage refers to this Instancer's blocks
+		throw;
+	}
+
+	if( setupGit ) {
+		gitStage.waitForFinished();
+		const QList<CinderBlockRef> staged = gitStage.result();
+		bool regenerate = false;
+		for( QList<CinderBlockRef>::ConstIterator blockIt = submoduleBlocks.begin(); blockIt != submoduleBlocks.end(); ++blockIt ) {
+			if( ! staged.contains( *blockIt ) ) {
+				(*blockIt)->setOutputPathToInput();
+				regenerate = true;
+			}
+		}
+		if( regenerate )
+			generateProjectFiles();
+	}
+
+	// create Resources.h; it extends the template's copy rather than replacing it, so it's written exactly once,
+	// after the git stage has settled every block's output path
+	{
+		TBOX_TRACE_SCOPE( "Instancer::writeResourcesHeader" );
+		writeResourcesHeader( conditions );
+	}
+
+	if( setupGit ) {
+		// now add it all to the master; the only step that waits on every writer
+		TBOX_TRACE_SCOPE( "Instancer: git commit" );
+		initialCommitToGitRepo( outputPath );
+	}
+
+	return copyStats;
+}
+
+// Writes everything the generators produce against the current output paths; safe to repeat, since each generator
+// rewrites its files from scratch
+void Instancer::generateProjectFiles()
+{
+	// resolve everything the generators will ask for
+	{
+		TBOX_TRACE_SCOPE( "Instancer::resolveManifest" );
+		resolveManifest();
+	}
+
+	// walk the children and generate with each generator
+	for( QList<GeneratorBaseRef>::Iterator childIt = mChildGenerators.begin(); childIt != mChildGenerators.end(); ++childIt )
+		(*childIt)->generate( this );
+}
+
+// Assigns every template's and block's output paths and records the copies generate() performs; touches nothing on disk
+void Instancer::planGenerate( QList<QMap<QString,QString> > *conditions, CopyPlan *copyPlan )
+{
 	for( QList<GeneratorBaseRef>::Iterator childIt = mChildGenerators.begin(); childIt != mChildGenerators.end(); ++childIt ) {
-		conditions.push_back( (*childIt)->getConditions() );
+		conditions->push_back( (*childIt)->getConditions() );
 		// for copying, where this list of conditions is used, any config or SDK is valid
-		conditions.back()["sdk"] = "*";
-		conditions.back()["config"] = "*";
+		conditions->back()["sdk"] = "*";
+		conditions->back()["config"] = "*";
 	}
 
 	// set template's output path
+	TBOX_TRACE_SCOPE( "Instancer::planGenerate" );
+	mTemplateFilesCache.clear();
+	mManifest.clear();
 	mProjectTmpl.setOutputPath( getOutputDir().absolutePath(), getNamePrefix(), getCinderAbsolutePath() );
 	if( mChildTemplate )
 		mChildTemplate->setOutputPath( getOutputDir().absolutePath(), getNamePrefix(), getCinderAbsolutePath() );
@@ -88,91 +240,104 @@ void Instancer::generate( bool setupGit )
 	}
 	
 	// copy any cinderblocks' files
-	for( QList<CinderBlockRef>::Iterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-		if( (*blockIt)->getInstallType() == CinderBlock::INSTALL_COPY )
-			(*blockIt)->instantiateFilesMatchingConditions( conditions, false );
+	{
+		TBOX_TRACE_SCOPE( "Instancer: plan block copies" );
+		for( QList<CinderBlockRef>::Iterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
+			if( (*blockIt)->getInstallType() == CinderBlock::INSTALL_COPY )
+				(*blockIt)->instantiateFilesMatchingConditions( *conditions, false, copyPlan, mBlockCopyMode, mCompareContents );
+		}
 	}
 
     // get all files which match our generators as well as the empty set of conditions
-	mProjectTmpl.instantiateFilesMatchingConditions( conditions, false );
+	{
+		TBOX_TRACE_SCOPE( "Instancer: plan template instantiation" );
+		mProjectTmpl.instantiateFilesMatchingConditions( *conditions, false, copyPlan, COPY_MODE_COPY, mCompareContents );
 
-	if( mChildTemplate )
-		mChildTemplate->instantiateFilesMatchingConditions( conditions, true );
+		if( mChildTemplate )
+			mChildTemplate->instantiateFilesMatchingConditions( *conditions, true, copyPlan, COPY_MODE_COPY, mCompareContents );
+	}
 
 	// bare files (<file> tags) are not the responsibility of the project generators, so the Instancer does 'em here
-	copyBareFiles( conditions );
+	copyBareFiles( *conditions, copyPlan );
 
 	// assets are a special case; we have to copy them all locally since they can't be made relative to the project. Can only live in /assets/
 	// do this before we git add
-	copyAssets( conditions );
+	{
+		TBOX_TRACE_SCOPE( "Instancer: plan assets" );
+		copyAssets( *conditions, copyPlan );
+	}
+}
 
-	// setup git repo and possibly submodules
-	if( setupGit ) {
-		setupGitRepo( getOutputDir().absolutePath() );
+GenerationPlan Instancer::createPlan( bool setupGit )
+{
+	GenerationPlan result;
+	result.setOutputPath( getOutputDir().absolutePath() );
 
-		// do the "git clone"/"git submodule add" dance for any appropriate submodules
-		for( QList<CinderBlockRef>::Iterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-			QDir::setCurrent( getOutputDir().absolutePath() );
-
-			if( (*blockIt)->getInstallType() == CinderBlock::INSTALL_GIT_SUBMODULE ) {
-				const QString relativeOutputPath = QString::fromUtf8( "blocks" ) + QDir::separator() + (*blockIt)->getName();
-				const QString blockParentPath = QDir::toNativeSeparators( (*blockIt)->getParentPath() );
-				makePath( getOutputDir().absolutePath() + QDir::separator() + "blocks" ); // Windows needs this to already exist
-				if( ! executeGitCommand( QStringList() << "clone" << "--recursive" << blockParentPath << relativeOutputPath ) ) {
-					continue;
-				}
-				if( ! executeGitCommand( QStringList() << "submodule" << "add" << (*blockIt)->getGitUrl() << relativeOutputPath ) ) {
-					continue;
-				}
-				if( ! executeGitCommand( QStringList() << "commit" << "-m" << ("\"Adding " + (*blockIt)->getName() + " submodule\"") ) ) {
-					continue;
-				}
-				QDir::setCurrent( getOutputDir().absolutePath() + QDir::separator() + relativeOutputPath );
-				if( ! executeGitCommand( QStringList() << "remote" << "set-url" << "origin" << (*blockIt)->getGitUrl() ) ) {
-					continue;
-				}
-				(*blockIt)->setOutputPath( getOutputDir().absolutePath() + QDir::separator() + relativeOutputPath, getNamePrefix(), getCinderAbsolutePath() );
-			}
+	// a plan for a run generate() would refuse is no plan at all
+	checkGenerate();
+
+	QList<QMap<QString,QString> > conditions;
+	CopyPlan copyPlan;
+	planGenerate( &conditions, &copyPlan );
+	result.addCopies( copyPlan );
+
+	const QString outputPath = getOutputDir().absolutePath();
+	if( setupGit ) {
+		result.addGitOperation( outputPath, QStringList() << "init" );
+		const QList<CinderBlockRef> submoduleBlocks = getGitSubmoduleBlocks();
+		for( QList<CinderBlockRef>::ConstIterator blockIt = submoduleBlocks.begin(); blockIt != submoduleBlocks.end(); ++blockIt ) {
+			result.addGitOperation( outputPath, gitSubmoduleCloneParams( *blockIt ) );
+			result.addGitOperation( outputPath + QDir::separator() + gitSubmoduleRelativePath( *blockIt ), QStringList() << "remote" << "set-url" << "origin" << (*blockIt)->getGitUrl() );
 		}
+		for( QList<CinderBlockRef>::ConstIterator blockIt = submoduleBlocks.begin(); blockIt != submoduleBlocks.end(); ++blockIt )
+			result.addGitOperation( outputPath, QStringList() << "submodule" << "add" << (*blockIt)->getGitUrl() << gitSubmoduleRelativePath( *blockIt ) );
+		if( ! submoduleBlocks.isEmpty() )
+			result.addGitOperation( outputPath, gitSubmodulesCommitParams( submoduleBlocks ) );
 	}
 
-	// walk the children and generate with each generator
-	for( QList<GeneratorBaseRef>::Iterator childIt = mChildGenerators.begin(); childIt != mChildGenerators.end(); ++childIt )
-		(*childIt)->generate( this );
-
-	// create Resources.h
-	writeResourcesHeader( conditions );
+	for( QList<GeneratorBaseRef>::ConstIterator childIt = mChildGenerators.begin(); childIt != mChildGenerators.end(); ++childIt ) {
+		const QStringList outputs = (*childIt)->getOutputPaths( this );
+		for( QStringList::ConstIterator outputIt = outputs.begin(); outputIt != outputs.end(); ++outputIt )
+			result.addGeneratedFile( getAbsolutePath( *outputIt ) );
+	}
+	result.addGeneratedFile( getAbsolutePath( "include/Resources.h" ) );
 
-	if( setupGit ) { // now add it all to the master
-		initialCommitToGitRepo( getOutputDir().absolutePath() );
+	if( setupGit ) {
+		result.addGitOperation( outputPath, QStringList() << "add" << "." );
+		result.addGitOperation( outputPath, QStringList() << "commit" << "-m" << "\"Initial commit\"" );
 	}
+
+	return result;
 }
 
-void Instancer::copyBareFiles( const QList<QMap<QString,QString> > &conditions ) const
+void Instancer::copyBareFiles( const QList<QMap<QString,QString> > &conditions, CopyPlan *plan ) const
 {
-	QList<Template::File> files = getFileTypeMatchingConditions<Template::File::FILE>( conditions, true );
+	// the template's files are always copied; a link would let edits to the new project change the shared template
+	Template::ItemRefs<Template::File> templateFiles = getTemplateFilesMatchingConditions( conditions );
+	for( const Template::File *file : templateFiles ) {
+		if( file->getType() == Template::File::FILE )
+			plan->add( file->getAbsoluteInputPath(), file->getAbsoluteOutputPath(), true, file->getReplaceContents(), getNamePrefix(), false, COPY_MODE_COPY, mCompareContents );
+	}
 
-	for( QList<Template::File>::Iterator fileIt = files.begin(); fileIt != files.end(); ++fileIt ) {
-		copyFileOrDir( fileIt->getAbsoluteInputPath(), fileIt->getAbsoluteOutputPath(), true, fileIt->getReplaceContents(), getNamePrefix() );
+	// copied blocks' files follow the block copy mode
+	Template::ItemRefs<Template::File> blockFiles = getBlockFileTypeMatchingConditions<Template::File::FILE>( conditions, true );
+	for( const Template::File *file : blockFiles ) {
+		plan->add( file->getAbsoluteInputPath(), file->getAbsoluteOutputPath(), true, file->getReplaceContents(), getNamePrefix(), false, mBlockCopyMode, mCompareContents );
 	}
 }
 
-void Instancer::copyAssets( const QList<QMap<QString,QString> > &conditions ) const
+void Instancer::copyAssets( const QList<QMap<QString,QString> > &conditions, CopyPlan *plan ) const
 {
-	// create the assets directory if necessary
 	QDir assetDirPath( getOutputDir().absolutePath() + "/assets/" );
-	if( ! assetDirPath.exists() ) {
-		getOutputDir().mkdir( "assets" );
-	}
 
-	QList<Template::File> assets = getFileTypeMatchingConditions<Template::File::ASSET>( conditions, false );
+	Template::ItemRefs<Template::File> assets = getFileTypeMatchingConditions<Template::File::ASSET>( conditions, false );
 
-	for( QList<Template::File>::Iterator assetIt = assets.begin(); assetIt != assets.end(); ++assetIt ) {
+	for( const Template::File *asset : assets ) {
 		// remove a prefix of 'assets' when necessary
-		QString relOutputPath = assetIt->getRelativeInputPath();
+		QString relOutputPath = asset->getRelativeInputPath();
 		if( relOutputPath.indexOf( "assets/") == 0 )
 			relOutputPath = relOutputPath.mid( QString("assets/").length() );
-		copyFileOrDir( assetIt->getAbsoluteInputPath(), assetDirPath.absoluteFilePath( relOutputPath ), true, assetIt->getReplaceContents(), getNamePrefix() );
+		plan->add( asset->getAbsoluteInputPath(), assetDirPath.absoluteFilePath( relOutputPath ), true, asset->getReplaceContents(), getNamePrefix(), false, mAssetCopyMode, mCompareContents );
 	}
 }
 
@@ -242,186 +407,199 @@ void Instancer::writeResourcesHeader( const QList<QMap<QString,QString> > &condi
 	ts << output;
 }
 
+Template::ItemRefs<Template::File> Instancer::getTemplateFilesMatchingConditions( const QList<QMap<QString,QString> > &conditions ) const
+{
+	const QString signature = Template::conditionsSignature( conditions );
+	QMap<QString,Template::ItemRefs<Template::File> >::ConstIterator cachedIt = mTemplateFilesCache.constFind( signature );
+	if( cachedIt != mTemplateFilesCache.constEnd() )
+		return cachedIt.value();
+
+	Template::ItemRefs<Template::File> parentFiles = mProjectTmpl.getFilesMatchingConditions( conditions );
+	Template::ItemRefs<Template::File> result;
+	if( ! mChildTemplate )
+		result = parentFiles;
+	else {
+		Template::ItemRefs<Template::File> childFiles = mChildTemplate->getFilesMatchingConditions( conditions );
+		// each child file overrides one parent file with the same output path
+		QHash<QString,int> overrides;
+		for( const Template::File *childFile : childFiles )
+			++overrides[QDir::cleanPath( childFile->getAbsoluteOutputPath() )];
+
+		result.reserve( parentFiles.size() + childFiles.size() );
+		for( const Template::File *parentFile : parentFiles ) {
+			QHash<QString,int>::Iterator overrideIt = overrides.find( QDir::cleanPath( parentFile->getAbsoluteOutputPath() ) );
+			if( overrideIt != overrides.end() && overrideIt.value() > 0 )
+				--overrideIt.value();
+			else
+				result.push_back( parentFile );
+		}
+		result += childFiles;
+	}
+
+	mTemplateFilesCache.insert( signature, result );
+	return result;
+}
+
 // 'getCopyOnly' returns only the files of copied CinderBlocks; appropriate for <asset> and <file>
 template<Template::File::Type FILE_TYPE>
-QList<Template::File> Instancer::getFileTypeMatchingConditions( const QList<QMap<QString,QString> > &conditions, bool getCopyOnly ) const
+Template::ItemRefs<Template::File> Instancer::getFileTypeMatchingConditions( const QList<QMap<QString,QString> > &conditions, bool getCopyOnly ) const
 {
-	QList<Template::File> allFiles;
-	
-	allFiles.append( mProjectTmpl.getFilesMatchingConditions( conditions ) );
-	if( mChildTemplate ) {
-		QList<Template::File> childFiles = mChildTemplate->getFilesMatchingConditions( conditions );
-		// iterate any files we received from the master template and override them with any equivalents from the child template
-		for( QList<Template::File>::ConstIterator childFile = childFiles.begin(); childFile != childFiles.end(); ++childFile ) {
-			for( QList<Template::File>::Iterator testFile = allFiles.begin(); testFile != allFiles.end(); ++testFile ) {
-				if( testFile->getAbsoluteOutputPath() == childFile->getAbsoluteOutputPath() ) {
-					allFiles.erase( testFile );
-					break;
-				}
-			}
-		}
-		allFiles.append( childFiles );
-	}
-	
+	Template::ItemRefs<Template::File> result;
+	Template::ItemRefs<Template::File> templateFiles = getTemplateFilesMatchingConditions( conditions );
+	for( const Template::File *file : templateFiles )
+		if( file->getType() == FILE_TYPE )
+			result.push_back( file );
+
+	result += getBlockFileTypeMatchingConditions<FILE_TYPE>( conditions, getCopyOnly );
+	return result;
+}
+
+// as getFileTypeMatchingConditions(), without the templates' files
+template<Template::File::Type FILE_TYPE>
+Template::ItemRefs<Template::File> Instancer::getBlockFileTypeMatchingConditions( const QList<QMap<QString,QString> > &conditions, bool getCopyOnly ) const
+{
+	Template::ItemRefs<Template::File> result;
 	for( QList<CinderBlockRef>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
 		if( getCopyOnly && ( (*blockIt)->getInstallType() != CinderBlock::INSTALL_COPY ) )
 			continue;
 		for( QList<QMap<QString,QString> >::ConstIterator condIt = conditions.begin(); condIt != conditions.end(); ++condIt ) {
 			if( (*blockIt)->supportsConditions( *condIt ) ) {
-				allFiles.append( (*blockIt)->getFilesMatchingConditions( conditions ) );
+				Template::ItemRefs<Template::File> blockFiles = (*blockIt)->getFilesMatchingConditions( conditions );
+				for( const Template::File *file : blockFiles )
+					if( file->getType() == FILE_TYPE )
+						result.push_back( file );
 				break;
 			}
 		}
 	}
 
-	// remove everything that isn't of type FILE_TYPE
-	QList<Template::File> result;
-	for( QList<Template::File>::Iterator fileIt = allFiles.begin(); fileIt != allFiles.end(); ++fileIt )
-		if( fileIt->getType() == FILE_TYPE )
-			result.push_back( *fileIt );
-
 	return result;
 }
 
 QList<Template::File> Instancer::getResourcesMatchingConditions( const QList<QMap<QString,QString> > &conditions ) const
 {
-	return getFileTypeMatchingConditions<Template::File::RESOURCE>( conditions, false );
+	QList<Template::File> result;
+	Template::ItemRefs<Template::File> resources = getFileTypeMatchingConditions<Template::File::RESOURCE>( conditions, false );
+	for( const Template::File *resource : resources )
+		result.push_back( *resource );
+
+	return result;
 }
 
-QList<Template::File> Instancer::getFilesMatchingConditions( const QMap<QString,QString> &conditions ) const
+// Evaluates every item category for 'conditions' in one walk of the templates and blocks
+Instancer::ResolvedItems Instancer::resolveItems( const QMap<QString,QString> &conditions ) const
 {
-	QList<Template::File> result;
-	result.append( mProjectTmpl.getFilesMatchingConditions( conditions ) );
+	ResolvedItems result;
+	result.mFiles = getTemplateFilesMatchingConditions( QList<QMap<QString,QString> >() << conditions );
+	result.mIncludePaths = mProjectTmpl.getIncludePathsMatchingConditions( conditions );
+	result.mLibraryPaths = mProjectTmpl.getLibraryPathsMatchingConditions( conditions );
+	result.mFrameworkPaths = mProjectTmpl.getFrameworkPathsMatchingConditions( conditions );
+	result.mStaticLibraries = mProjectTmpl.getStaticLibrariesMatchingConditions( conditions );
+	result.mDynamicLibraries = mProjectTmpl.getDynamicLibrariesMatchingConditions( conditions );
+	result.mBuildSettings = mProjectTmpl.getBuildSettingsMatchingConditions( conditions );
+	result.mPreprocessorDefines = mProjectTmpl.getPreprocessorDefinesMatchingConditions( conditions );
+	result.mOutputExtensions = mProjectTmpl.getOutputExtensionsMatchingConditions( conditions );
+
+	// static libraries are taken from the project template alone
 	if( mChildTemplate ) {
-		QList<Template::File> childFiles = mChildTemplate->getFilesMatchingConditions( conditions );
-		// iterate any files we received from the master template and override them with any equivalents from the child template
-		for( QList<Template::File>::ConstIterator childFile = childFiles.begin(); childFile != childFiles.end(); ++childFile ) {
-			for( QList<Template::File>::Iterator testFile = result.begin(); testFile != result.end(); ++testFile ) {
-				if( testFile->getAbsoluteOutputPath() == childFile->getAbsoluteOutputPath() ) {
-					result.erase( testFile );
-					break;
-				}
-			}
-		}
-		result.append( childFiles );
+		result.mIncludePaths += mChildTemplate->getIncludePathsMatchingConditions( conditions );
+		result.mLibraryPaths += mChildTemplate->getLibraryPathsMatchingConditions( conditions );
+		result.mFrameworkPaths += mChildTemplate->getFrameworkPathsMatchingConditions( conditions );
+		result.mDynamicLibraries += mChildTemplate->getDynamicLibrariesMatchingConditions( conditions );
+		result.mBuildSettings += mChildTemplate->getBuildSettingsMatchingConditions( conditions );
+		result.mPreprocessorDefines += mChildTemplate->getPreprocessorDefinesMatchingConditions( conditions );
+		result.mOutputExtensions += mChildTemplate->getOutputExtensionsMatchingConditions( conditions );
 	}
 
 	for( QList<CinderBlockRef>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-		if( (*blockIt)->supportsConditions( conditions ) )
-			result.append( (*blockIt)->getFilesMatchingConditions( conditions ) );
+		if( ! (*blockIt)->supportsConditions( conditions ) )
+			continue;
+		result.mFiles += (*blockIt)->getFilesMatchingConditions( conditions );
+		result.mIncludePaths += (*blockIt)->getIncludePathsMatchingConditions( conditions );
+		result.mLibraryPaths += (*blockIt)->getLibraryPathsMatchingConditions( conditions );
+		result.mFrameworkPaths += (*blockIt)->getFrameworkPathsMatchingConditions( conditions );
+		result.mStaticLibraries += (*blockIt)->getStaticLibrariesMatchingConditions( conditions );
+		result.mDynamicLibraries += (*blockIt)->getDynamicLibrariesMatchingConditions( conditions );
+		result.mBuildSettings += (*blockIt)->getBuildSettingsMatchingConditions( conditions );
+		result.mPreprocessorDefines += (*blockIt)->getPreprocessorDefinesMatchingConditions( conditions );
+		result.mOutputExtensions += (*blockIt)->getOutputExtensionsMatchingConditions( conditions );
 	}
 
 	return result;
 }
 
-QList<Template::IncludePath> Instancer::getIncludePathsMatchingConditions( const QMap<QString,QString> &conditions ) const
+const Instancer::ResolvedItems& Instancer::getResolvedItems( const QMap<QString,QString> &conditions ) const
 {
-	QList<Template::IncludePath> result;
-	result.append( mProjectTmpl.getIncludePathsMatchingConditions( conditions ) );
-	if( mChildTemplate )
-		result.append( mChildTemplate->getIncludePathsMatchingConditions( conditions ) );
-	for( QList<CinderBlockRef>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-		if( (*blockIt)->supportsConditions( conditions ) )
-			result.append( (*blockIt)->getIncludePathsMatchingConditions( conditions ) );
-	}
+	const QString signature = Template::conditionsSignature( conditions );
+	QMap<QString,ResolvedItems>::ConstIterator resolvedIt = mManifest.constFind( signature );
+	if( resolvedIt == mManifest.constEnd() )
+		resolvedIt = mManifest.insert( signature, resolveItems( conditions ) );
 
-	return result;
+	return resolvedIt.value();
 }
 
-QList<Template::LibraryPath> Instancer::getLibraryPathsMatchingConditions( const QMap<QString,QString> &conditions ) const
+// Resolves every set of conditions the generators will query up front, so that all of them read from one table
+void Instancer::resolveManifest()
 {
-	QList<Template::LibraryPath> result;
-	result.append( mProjectTmpl.getLibraryPathsMatchingConditions( conditions ) );
-	if( mChildTemplate )
-		result.append( mChildTemplate->getLibraryPathsMatchingConditions( conditions ) );
-	for( QList<CinderBlockRef>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-		if( (*blockIt)->supportsConditions( conditions ) )
-			result.append( (*blockIt)->getLibraryPathsMatchingConditions( conditions ) );
+	mManifest.clear();
+	for( QList<GeneratorBaseRef>::ConstIterator childIt = mChildGenerators.begin(); childIt != mChildGenerators.end(); ++childIt ) {
+		const QList<QMap<QString,QString> > queries = (*childIt)->getQueryConditions();
+		for( QList<QMap<QString,QString> >::ConstIterator queryIt = queries.begin(); queryIt != queries.end(); ++queryIt )
+			getResolvedItems( *queryIt );
 	}
-
-	return result;
 }
 
-QList<Template::FrameworkPath> Instancer::getFrameworkPathsMatchingConditions( const QMap<QString,QString> &conditions ) const
+Template::ItemRefs<Template::File> Instancer::getFilesMatchingConditions( const QMap<QString,QString> &conditions ) const
 {
-	QList<Template::FrameworkPath> result;
-	result.append( mProjectTmpl.getFrameworkPathsMatchingConditions( conditions ) );
-	if( mChildTemplate )
-		result.append( mChildTemplate->getFrameworkPathsMatchingConditions( conditions ) );
-	for( QList<CinderBlockRef>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-		if( (*blockIt)->supportsConditions( conditions ) )
-			result.append( (*blockIt)->getFrameworkPathsMatchingConditions( conditions ) );
-	}
-
-	return result;
+	return getResolvedItems( conditions ).mFiles;
 }
 
-QList<Template::StaticLibrary> Instancer::getStaticLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const
+Template::ItemRefs<Template::IncludePath> Instancer::getIncludePathsMatchingConditions( const QMap<QString,QString> &conditions ) const
 {
-	QList<Template::StaticLibrary> result;
-	result.append( mProjectTmpl.getStaticLibrariesMatchingConditions( conditions ) );
-	for( QList<CinderBlockRef>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-		if( (*blockIt)->supportsConditions( conditions ) )
-			result.append( (*blockIt)->getStaticLibrariesMatchingConditions( conditions ) );
-		}
-
-	return result;
+	return getResolvedItems( conditions ).mIncludePaths;
 }
 
-QList<Template::DynamicLibrary> Instancer::getDynamicLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const
+Template::ItemRefs<Template::LibraryPath> Instancer::getLibraryPathsMatchingConditions( const QMap<QString,QString> &conditions ) const
 {
-	QList<Template::DynamicLibrary> result;
-	result.append( mProjectTmpl.getDynamicLibrariesMatchingConditions( conditions ) );
-	if( mChildTemplate )
-		result.append( mChildTemplate->getDynamicLibrariesMatchingConditions( conditions ) );
-	for( QList<CinderBlockRef>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-		if( (*blockIt)->supportsConditions( conditions ) )
-			result.append( (*blockIt)->getDynamicLibrariesMatchingConditions( conditions ) );
-		}
+	return getResolvedItems( conditions ).mLibraryPaths;
+}
 
-	return result;
+Template::ItemRefs<Template::FrameworkPath> Instancer::getFrameworkPathsMatchingConditions( const QMap<QString,QString> &conditions ) const
+{
+	return getResolvedItems( conditions ).mFrameworkPaths;
 }
 
-QList<Template::BuildSetting> Instancer::getBuildSettingsMatchingConditions( const QMap<QString,QString> &conditions ) const
+Template::ItemRefs<Template::StaticLibrary> Instancer::getStaticLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const
 {
-	QList<Template::BuildSetting> result;
-	result.append( mProjectTmpl.getBuildSettingsMatchingConditions( conditions ) );
-	if( mChildTemplate )
-		result.append( mChildTemplate->getBuildSettingsMatchingConditions( conditions ) );
-	for( QList<CinderBlockRef>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-		if( (*blockIt)->supportsConditions( conditions ) )
-			result.append( (*blockIt)->getBuildSettingsMatchingConditions( conditions ) );
-	}
+	return getResolvedItems( conditions ).mStaticLibraries;
+}
 
-	return result;
+Template::ItemRefs<Template::DynamicLibrary> Instancer::getDynamicLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const
+{
+	return getResolvedItems( conditions ).mDynamicLibraries;
 }
 
-QList<Template::PreprocessorDefine> Instancer::getPreprocessorDefinesMatchingConditions( const QMap<QString,QString> &conditions ) const
+Template::ItemRefs<Template::BuildSetting> Instancer::getBuildSettingsMatchingConditions( const QMap<QString,QString> &conditions ) const
 {
-	QList<Template::PreprocessorDefine> result;
-	result.append( mProjectTmpl.getPreprocessorDefinesMatchingConditions( conditions ) );
-	if( mChildTemplate )
-		result.append( mChildTemplate->getPreprocessorDefinesMatchingConditions( conditions ) );
-	for( QList<CinderBlockRef>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-		if( (*blockIt)->supportsConditions( conditions ) )
-			result.append( (*blockIt)->getPreprocessorDefinesMatchingConditions( conditions ) );
-	}
+	return getResolvedItems( conditions ).mBuildSettings;
+}
 
-	return result;
+Template::ItemRefs<Template::PreprocessorDefine> Instancer::getPreprocessorDefinesMatchingConditions( const QMap<QString,QString> &conditions ) const
+{
+	return getResolvedItems( conditions ).mPreprocessorDefines;
 }
 
-QList<Template::OutputExtension> Instancer::getOutputExtensionsMatchingConditions( const QMap<QString,QString> &conditions ) const
+Template::ItemRefs<Template::OutputExtension> Instancer::getOutputExtensionsMatchingConditions( const QMap<QString,QString> &conditions ) const
 {
-	QList<Template::OutputExtension> result;
-	result.append( mProjectTmpl.getOutputExtensionsMatchingConditions( conditions ) );
-	if( mChildTemplate )
-		result.append( mChildTemplate->getOutputExtensionsMatchingConditions( conditions ) );
-	for( QList<CinderBlockRef>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-		if( (*blockIt)->supportsConditions( conditions ) )
-			result.append( (*blockIt)->getOutputExtensionsMatchingConditions( conditions ) );
-	}
+	return getResolvedItems( conditions ).mOutputExtensions;
+}
 
-	return result;
+void Instancer::addCinderBlock( const CinderBlock &block )
+{
+	CinderBlockRef blockRef( new CinderBlock( block ) );
+	ErrorList ignored;
+	blockRef->ensureParsed( &ignored );
+	mCinderBlocks.push_back( blockRef );
 }
 
 void Instancer::addGenerator( GeneratorBase *childGen )
@@ -429,25 +607,18 @@ void Instancer::addGenerator( GeneratorBase *childGen )
 	mChildGenerators.push_back( QSharedPointer<GeneratorBase>( childGen ) );
 }
 
-// Creates the destination directory, sets Cinder location
-bool Instancer::prepareGenerate()
+// Throws GenerateFailed if generate() would refuse to run; touches nothing on disk
+void Instancer::checkGenerate() const
 {
 	QString cinderLocation = getCinderAbsolutePath();
 	if( ! dirExists( cinderLocation )  ) {
 		throw GenerateFailed( "Cinder location is invalid or does not exist: " + cinderLocation );
 	}
 
-	if( ! dirExists( getBaseLocation() ) ) {
-		QString msg = "The directory \"" + getBaseLocation() + "\" doesn't exist. Should TinderBox create it?";
-		QString heading = "Confirm Directory Creation";
-		if( showConfirmMsg( msg, heading ) ) {
-			if( ! makePath( getBaseLocation() ) ) {
-				throw GenerateFailed( "Couldn't create directory: " + getBaseLocation() );
-			}
-		}
-		else {
-			return false;
-		}
+	// a missing base location is created, which can't succeed if a file is in the way
+	const QFileInfo baseLocation( getBaseLocation() );
+	if( baseLocation.exists() && ( ! baseLocation.isDir() ) ) {
+		throw GenerateFailed( "Couldn't create directory: " + getBaseLocation() );
 	}
 
 	QString destinationPath = joinPath( getBaseLocation(), getProjectName() );
@@ -455,7 +626,22 @@ bool Instancer::prepareGenerate()
 	if( destinationDir.exists() ) {
 		throw GenerateFailed( destinationPath + " already exists! Please specify a different Name Prefix." );
 	}
+}
+
+// Creates the destination directory, sets Cinder location
+bool Instancer::prepareGenerate()
+{
+	checkGenerate();
+	QString cinderLocation = getCinderAbsolutePath();
+
+	// callers with a UI should confirm this beforehand; see MainWizard::generateProject()
+	if( ! dirExists( getBaseLocation() ) ) {
+		if( ! makePath( getBaseLocation() ) ) {
+			throw GenerateFailed( "Couldn't create directory: " + getBaseLocation() );
+		}
+	}
 
+	QString destinationPath = joinPath( getBaseLocation(), getProjectName() );
 	if( ! makePath( destinationPath ) ) {
 		throw GenerateFailed( "Couldn't create Project directory: " + destinationPath );
 	}
@@ -468,16 +654,65 @@ bool Instancer::prepareGenerate()
 
 bool Instancer::setupGitRepo( const QString &dirPath )
 {
-	QDir::setCurrent( dirPath );
-	return executeGitCommand( QStringList() << "init" );
+	return executeGitCommand( dirPath, QStringList() << "init" );
+}
+
+QList<CinderBlockRef> Instancer::getGitSubmoduleBlocks() const
+{
+	QList<CinderBlockRef> result;
+	for( QList<CinderBlockRef>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
+		if( (*blockIt)->getInstallType() == CinderBlock::INSTALL_GIT_SUBMODULE )
+			result.append( *blockIt );
+	}
+	return result;
+}
+
+// Runs on its own thread during generate(): 'git init' plus the submodule setup. Returns the blocks that were committed as submodules
+QList<CinderBlockRef> Instancer::setupGitStage( const QString &outputPath, const QList<CinderBlockRef> &blocks )
+{
+	TBOX_TRACE_SCOPE( "Instancer: git setup" );
+	if( ! setupGitRepo( outputPath ) )
+		return QList<CinderBlockRef>();
+	return setupGitSubmodules( outputPath, blocks );
+}
+
+// Clones every submodule block concurrently, then stages them all (serially, since 'submodule add' writes the shared index and .gitmodules) under a single commit
+QList<CinderBlockRef> Instancer::setupGitSubmodules( const QString &outputPath, const QList<CinderBlockRef> &blocks ) const
+{
+	if( blocks.isEmpty() )
+		return QList<CinderBlockRef>();
+
+	makePath( outputPath + QDir::separator() + "blocks" ); // Windows needs this to already exist
+
+	QVector<bool> cloned( blocks.size(), false );
+	{
+		QThreadPool pool;
+		pool.setMaxThreadCount( qMax( 1, qMin( QThread::idealThreadCount(), blocks.size() ) ) );
+		for( int b = 0; b < blocks.size(); ++b )
+			pool.start( new GitCloneTask( outputPath, blocks[b], &cloned[b] ) );
+		pool.waitForDone();
+	}
+
+	QList<CinderBlockRef> staged;
+	for( int b = 0; b < blocks.size(); ++b ) {
+		if( ! cloned[b] )
+			continue;
+		if( ! executeGitCommand( outputPath, QStringList() << "submodule" << "add" << blocks[b]->getGitUrl() << gitSubmoduleRelativePath( blocks[b] ) ) )
+			continue;
+		staged.append( blocks[b] );
+	}
+
+	if( staged.isEmpty() || ! executeGitCommand( outputPath, gitSubmodulesCommitParams( staged ) ) )
+		return QList<CinderBlockRef>();
+
+	return staged;
 }
 
 bool Instancer::initialCommitToGitRepo( const QString &dirPath )
 {
-	QDir::setCurrent( dirPath );
-	if( ! executeGitCommand( QStringList() << "add" << "." ) )
+	if( ! executeGitCommand( dirPath, QStringList() << "add" << "." ) )
 		return false;
-	if( ! executeGitCommand( QStringList() << "commit" << "-m" << "\"Initial commit\"" ) )
+	if( ! executeGitCommand( dirPath, QStringList() << "commit" << "-m" << "\"Initial commit\"" ) )
 		return false;
 	return true;
 }
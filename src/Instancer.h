@@ -29,27 +29,36 @@
 
 #include "GeneratorBase.h"
 #include "CinderBlock.h"
+#include "GenerationPlan.h"
 #include "Template.h"
 
 class Instancer {
   public:
     Instancer( const ProjectTemplate &projectTmpl );
 
-	QList<Template::File>			 getFilesMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<Template::File>			 getResourcesMatchingConditions( const QList<QMap<QString,QString> > &conditions ) const;
-	QList<Template::IncludePath>	 getIncludePathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<Template::LibraryPath>	 getLibraryPathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<Template::FrameworkPath>	 getFrameworkPathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<Template::StaticLibrary>	 getStaticLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<Template::DynamicLibrary>	 getDynamicLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<Template::BuildSetting>	 getBuildSettingsMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<Template::PreprocessorDefine> getPreprocessorDefinesMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<Template::OutputExtension> getOutputExtensionsMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	// Query results reference items owned by the project template, child template and CinderBlocks held by this Instancer.
+	// Once generate() has assigned output paths they remain valid for the life of the Instancer.
+	Template::ItemRefs<Template::File>				getFilesMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	Template::ItemRefs<Template::IncludePath>		getIncludePathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	Template::ItemRefs<Template::LibraryPath>		getLibraryPathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	Template::ItemRefs<Template::FrameworkPath>		getFrameworkPathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	Template::ItemRefs<Template::StaticLibrary>		getStaticLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	Template::ItemRefs<Template::DynamicLibrary>	getDynamicLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	Template::ItemRefs<Template::BuildSetting>		getBuildSettingsMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	Template::ItemRefs<Template::PreprocessorDefine>	getPreprocessorDefinesMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	Template::ItemRefs<Template::OutputExtension>	getOutputExtensionsMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	// returns copies, since resource IDs are assigned on the results
+	QList<Template::File>			getResourcesMatchingConditions( const QList<QMap<QString,QString> > &conditions ) const;
 
 	// takes ownership of childGen
 	void			addGenerator( GeneratorBase *childGen );
-	void			addCinderBlock( const CinderBlock &block ) { mCinderBlocks.push_back( CinderBlockRef( new CinderBlock( block ) ) ); }
-	void			generate( bool setupGit );
+	// 'block' should already have been parsed, see CinderBlock::ensureParsed(); otherwise it is parsed here and any warnings are dropped
+	void			addCinderBlock( const CinderBlock &block );
+	// returns what the copies did; the generated project files aren't counted
+	CopyStats		generate( bool setupGit );
+	// what generate() would do, computed without writing anything; note this assigns output paths just as generate() does.
+	// Throws GenerateFailed where generate() would, ie when the project's directory already exists
+	GenerationPlan	createPlan( bool setupGit );
 
 	QString         getProjectName() const;
 	void            setProjectName( const QString &projName );
@@ -67,19 +76,58 @@ class Instancer {
 	QString			getCinderAbsolutePath() const { return mAbsCinderPath; }
 	void            setCinderAbsolutePath( const QString &absCinderPath );
 
+	// the number of threads generate() copies files with; 0 uses QThread::idealThreadCount()
+	int				getCopyThreadCount() const { return mCopyThreadCount; }
+	void			setCopyThreadCount( int count ) { mCopyThreadCount = count; }
+	// how the files of INSTALL_COPY blocks and of <asset>s are materialized; templates are always copied
+	CopyMode		getBlockCopyMode() const { return mBlockCopyMode; }
+	void			setBlockCopyMode( CopyMode mode ) { mBlockCopyMode = mode; }
+	CopyMode		getAssetCopyMode() const { return mAssetCopyMode; }
+	void			setAssetCopyMode( CopyMode mode ) { mAssetCopyMode = mode; }
+	// whether an existing destination whose size and mtime match its source must also match its data to be kept
+	bool			getCompareContents() const { return mCompareContents; }
+	void			setCompareContents( bool compare ) { mCompareContents = compare; }
+
 	QString			createDirectory( QString relPath ) const;
 	QString			getAbsolutePath( QString relPath ) const;
 
   private:
 	template<Template::File::Type FILE_TYPE>
-	QList<Template::File> getFileTypeMatchingConditions( const QList<QMap<QString,QString> > &conditions, bool getCopyOnly ) const;
-
+	Template::ItemRefs<Template::File> getFileTypeMatchingConditions( const QList<QMap<QString,QString> > &conditions, bool getCopyOnly ) const;
+	template<Template::File::Type FILE_TYPE>
+	Template::ItemRefs<Template::File> getBlockFileTypeMatchingConditions( const QList<QMap<QString,QString> > &conditions, bool getCopyOnly ) const;
+	// the project template's files with the child template's overrides applied; memoized per set of conditions
+	Template::ItemRefs<Template::File> getTemplateFilesMatchingConditions( const QList<QMap<QString,QString> > &conditions ) const;
+
+	// every item category matching one set of conditions, drawn from the project template, child template and blocks
+	struct ResolvedItems {
+		Template::ItemRefs<Template::File>					mFiles;
+		Template::ItemRefs<Template::IncludePath>			mIncludePaths;
+		Template::ItemRefs<Template::LibraryPath>			mLibraryPaths;
+		Template::ItemRefs<Template::FrameworkPath>			mFrameworkPaths;
+		Template::ItemRefs<Template::StaticLibrary>			mStaticLibraries;
+		Template::ItemRefs<Template::DynamicLibrary>		mDynamicLibraries;
+		Template::ItemRefs<Template::BuildSetting>			mBuildSettings;
+		Template::ItemRefs<Template::PreprocessorDefine>	mPreprocessorDefines;
+		Template::ItemRefs<Template::OutputExtension>		mOutputExtensions;
+	};
+
+	ResolvedItems			resolveItems( const QMap<QString,QString> &conditions ) const;
+	const ResolvedItems&	getResolvedItems( const QMap<QString,QString> &conditions ) const;
+	void					resolveManifest();
+
+	void			checkGenerate() const;
 	bool			prepareGenerate();
+	void			planGenerate( QList<QMap<QString,QString> > *conditions, CopyPlan *copyPlan );
+	void			generateProjectFiles();
 	void			writeResourcesHeader( const QList<QMap<QString,QString> > &conditions ) const;
-	void			copyAssets( const QList<QMap<QString,QString> > &conditions ) const;
-	void			copyBareFiles( const QList<QMap<QString,QString> > &conditions ) const;
+	void			copyAssets( const QList<QMap<QString,QString> > &conditions, CopyPlan *plan ) const;
+	void			copyBareFiles( const QList<QMap<QString,QString> > &conditions, CopyPlan *plan ) const;
 	QString         getRelCinderPath( const QString &relativeTo ) const;
 	bool			setupGitRepo( const QString &dirPath );
+	QList<CinderBlockRef>	getGitSubmoduleBlocks() const;
+	QList<CinderBlockRef>	setupGitStage( const QString &outputPath, const QList<CinderBlockRef> &blocks );
+	QList<CinderBlockRef>	setupGitSubmodules( const QString &outputPath, const QList<CinderBlockRef> &blocks ) const;
 	bool			initialCommitToGitRepo( const QString &dirPath );
 
     ProjectTemplate					mProjectTmpl;
@@ -89,7 +137,15 @@ class Instancer {
 	QString         mNamePrefix;
 	QString         mBaseLocation;
 	QString         mAbsCinderPath;
+	int				mCopyThreadCount;
+	CopyMode		mBlockCopyMode, mAssetCopyMode;
+	bool			mCompareContents;
 
 	QList<GeneratorBaseRef>		mChildGenerators;
 	QList<CinderBlockRef>		mCinderBlocks;
+
+	// keyed by Template::conditionsSignature(); cleared whenever the templates' output paths change
+	mutable QMap<QString,Template::ItemRefs<Template::File> >	mTemplateFilesCache;
+	// the resolved manifest, keyed by Template::conditionsSignature(); filled by resolveManifest() before the generators run
+	mutable QMap<QString,ResolvedItems>						mManifest;
 };
@@ -30,11 +30,13 @@
 #include "Instancer.h"
 #include "ProjectTemplateManager.h"
 #include "CinderBlockManager.h"
+#include "ManifestWatcher.h"
 #include "GeneratorXcodeMac.h"
 #include "GeneratorXcodeIos.h"
 #include "GeneratorVc2015Winrt.h"
 #include "GeneratorVc2015.h"
 #include "Util.h"
+#include "UtilGui.h"
 
 #include <QAbstractButton>
 #include <QFileDialog>
@@ -54,6 +56,12 @@ MainWizard::MainWizard(QWidget *parent) :
 	QWizard(parent),
 	mWizardPageMain( 0 ), mWizardPageCinderBlocks( 0 ) // NULL to ensure we don't update them prematurely
 {
+	// edits to the current Cinder tree's templates and CinderBlocks show up without switching versions
+	mTemplateWatcher = new ManifestWatcher( this );
+	mCinderBlockWatcher = new ManifestWatcher( this );
+	connect( mTemplateWatcher, SIGNAL(changed()), this, SLOT(templatesChanged()) );
+	connect( mCinderBlockWatcher, SIGNAL(changed()), this, SLOT(cinderBlocksChanged()) );
+
 	checkForFirstTime();
 	loadPreferences();
 	setCinderPathToHousingPath();
@@ -217,6 +225,13 @@ bool MainWizard::checkForFirstTime()
 
 void MainWizard::generateProject()
 {
+	if( ! dirExists( mWizardPageMain->getLocation() ) ) {
+		QString msg = "The directory \"" + mWizardPageMain->getLocation() + "\" doesn't exist. Should TinderBox create it?";
+		QString heading = "Confirm Directory Creation";
+		if( ! showConfirmMsg( msg, heading ) )
+			return;
+	}
+
 	try {
 		Instancer gen( mWizardPageMain->getProjectTemplate() );
 #if 0
@@ -227,6 +242,10 @@ void MainWizard::generateProject()
 		gen.setNamePrefix( mWizardPageMain->getProjectName() );
 		gen.setBaseLocation( mWizardPageMain->getLocation() );
 		gen.setCinderAbsolutePath( mWizardPageMain->getCinderLocation() );
+		gen.setCopyThreadCount( Preferences::getCopyThreadCount() );
+		gen.setBlockCopyMode( Preferences::getBlockCopyMode() );
+		gen.setAssetCopyMode( Preferences::getAssetCopyMode() );
+		gen.setCompareContents( Preferences::getCompareCopiedContents() );
 
 		if( mWizardPageMain->isXcodeSelected() )
 			gen.addGenerator( new GeneratorXcodeMac() );
@@ -247,9 +266,11 @@ void MainWizard::generateProject()
 			options.enableArm( mWizardPageEnvOptions->isVc2015WinRtArmSelected() );
             gen.addGenerator( new GeneratorVc2015WinRt( options ) );
 		}
-		for( QList<CinderBlock>::ConstIterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
-			if( blockIt->getInstallType() != CinderBlock::INSTALL_NONE )
+		for( QList<CinderBlock>::Iterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
+			if( blockIt->getInstallType() != CinderBlock::INSTALL_NONE ) {
+				ensureCinderBlockParsed( &(*blockIt) );
 				gen.addCinderBlock( *blockIt );
+			}
 		}
 
 		gen.generate( mWizardPageMain->shouldCreateGitRepo() );
@@ -277,13 +298,8 @@ void MainWizard::setCinderLocationByIndex( int index )
 
 	auto cinderLocationPath = Preferences::getCinderVersions()[index].path;
 
-	ProjectTemplateManager::clear();
-	mTemplateErrors.clear();
-	ProjectTemplateManager::setCinderDir( cinderLocationPath, &mTemplateErrors );
-
-	CinderBlockManager::clear();
-	mCinderBlockErrors.clear();
-	CinderBlockManager::scan( cinderLocationPath, &mCinderBlockErrors );
+	scanTemplates();
+	scanCinderBlocks();
 
 	mCinderBlocks = CinderBlockManager::getCinderBlocks();
 
@@ -293,6 +309,54 @@ void MainWizard::setCinderLocationByIndex( int index )
 		mWizardPageCinderBlocks->setCinderLocation( cinderLocationPath );
 }
 
+void MainWizard::scanTemplates()
+{
+	ProjectTemplateManager::clear();
+	mTemplateErrors.clear();
+	ProjectTemplateManager::setCinderDir( getCinderLocation(), &mTemplateErrors );
+	mTemplateWatcher->setPaths( ProjectTemplateManager::getWatchPaths() );
+}
+
+void MainWizard::scanCinderBlocks()
+{
+	CinderBlockManager::clear();
+	mCinderBlockErrors.clear();
+	CinderBlockManager::scan( getCinderLocation(), &mCinderBlockErrors );
+	mCinderBlockWatcher->setPaths( CinderBlockManager::getWatchPaths() );
+}
+
+void MainWizard::templatesChanged()
+{
+	scanTemplates();
+	mWizardPageMain->updateTemplates();
+	if( currentId() == PAGE_CINDER_BLOCKS ) { // otherwise this happens on the way there
+		refreshRequiredBlocks();
+		mWizardPageCinderBlocks->setCinderLocation( getCinderLocation() );
+	}
+}
+
+void MainWizard::cinderBlocksChanged()
+{
+	scanCinderBlocks();
+
+	// keep the install types chosen for the blocks that are still there
+	QList<CinderBlock> cinderBlocks = CinderBlockManager::getCinderBlocks();
+	for( QList<CinderBlock>::Iterator blockIt = cinderBlocks.begin(); blockIt != cinderBlocks.end(); ++blockIt ) {
+		const CinderBlock *previous = findCinderBlockById( blockIt->getId() );
+		if( previous )
+			blockIt->setInstallType( previous->getInstallType() );
+	}
+	mCinderBlocks = cinderBlocks;
+
+	// the template list includes the blocks' own templates and checks every template's required blocks, but the
+	// app templates themselves are unchanged and aren't rescanned
+	mWizardPageMain->updateTemplates();
+	if( currentId() == PAGE_CINDER_BLOCKS ) { // otherwise this happens on the way there
+		refreshRequiredBlocks();
+		mWizardPageCinderBlocks->setCinderLocation( getCinderLocation() );
+	}
+}
+
 CinderBlock* MainWizard::findCinderBlockById( const QString &searchId )
 {
 	for( QList<CinderBlock>::Iterator blockIt = mCinderBlocks.begin(); blockIt != mCinderBlocks.end(); ++blockIt ) {
@@ -25,7 +25,7 @@
 #define MAINWIZARD_H
 
 #include <QWizard>
-#include "Preferences.h"
+#include "PrefsDlg.h"
 #include "CinderBlock.h"
 #include "ProjectTemplate.h"
 #include "ErrorList.h"
@@ -33,6 +33,7 @@
 class WizardPageMain;
 class WizardPageEnvOptions;
 class WizardPageCinderBlocks;
+class ManifestWatcher;
 
 class MainWizard : public QWizard
 {
@@ -56,6 +57,8 @@ void paintEvent( QPaintEvent *event );
 	const ErrorList&	getTemplateErrorList() const { return mTemplateErrors; }
 	ErrorList&			getTemplateErrorList() { return mTemplateErrors; }
 	const ErrorList&	getCinderBlockErrorList() const { return mCinderBlockErrors; }	
+	// blocks are scanned header-only; this parses one's contents on first use, reporting into the CinderBlock errors
+	void				ensureCinderBlockParsed( CinderBlock *block ) { block->ensureParsed( &mCinderBlockErrors ); }
 
 	const WizardPageMain*	getWizardPageMain() const { return mWizardPageMain; }
 signals:
@@ -65,16 +68,23 @@ public slots:
 	void		advancingToNextPage( int newId );
 	void		generateProject();
 
+private slots:
+	void		templatesChanged();
+	void		cinderBlocksChanged();
+
 private:
     int             nextId() const override;
 	bool			checkForFirstTime();
 	void			loadPreferences();
 	void			loadTemplates();
+	void			scanTemplates();
+	void			scanCinderBlocks();
 	void			requireBlocks( const QList<QString> &dependencyNames );
 
 	WizardPageMain			*mWizardPageMain;
 	WizardPageCinderBlocks	*mWizardPageCinderBlocks;
 	WizardPageEnvOptions    *mWizardPageEnvOptions;
+	ManifestWatcher			*mTemplateWatcher, *mCinderBlockWatcher;
 	Prefs					*mPrefs;
 	int						mCinderLocationIndex;
 	ErrorList				mTemplateErrors, mCinderBlockErrors;
@@ -0,0 +1,68 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "ManifestWatcher.h"
+
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QTimer>
+
+// editors tend to save in several steps (write, rename, touch); wait this long after the last event before rescanning
+static const int SETTLE_MSECS = 250;
+
+ManifestWatcher::ManifestWatcher( QObject *parent )
+	: QObject( parent )
+{
+	mWatcher = new QFileSystemWatcher( this );
+	mSettleTimer = new QTimer( this );
+	mSettleTimer->setSingleShot( true );
+	mSettleTimer->setInterval( SETTLE_MSECS );
+
+	connect( mWatcher, SIGNAL(fileChanged(QString)), this, SLOT(pathChanged(QString)) );
+	connect( mWatcher, SIGNAL(directoryChanged(QString)), this, SLOT(pathChanged(QString)) );
+	connect( mSettleTimer, SIGNAL(timeout()), this, SIGNAL(changed()) );
+}
+
+void ManifestWatcher::setPaths( const QStringList &paths )
+{
+	QSet<QString> wanted;
+	for( QStringList::ConstIterator pathIt = paths.begin(); pathIt != paths.end(); ++pathIt ) {
+		if( QFileInfo( *pathIt ).exists() )
+			wanted.insert( *pathIt );
+	}
+
+	// only touch what differs; a file replaced by an editor's atomic save drops out of files() and is added back here
+	QSet<QString> watched = QSet<QString>::fromList( mWatcher->files() + mWatcher->directories() );
+	const QStringList toRemove = QSet<QString>( watched ).subtract( wanted ).toList();
+	const QStringList toAdd = wanted.subtract( watched ).toList();
+	if( ! toRemove.isEmpty() )
+		mWatcher->removePaths( toRemove );
+	if( ! toAdd.isEmpty() )
+		mWatcher->addPaths( toAdd );
+}
+
+void ManifestWatcher::pathChanged( const QString &/*path*/ )
+{
+	mSettleTimer->start();
+}
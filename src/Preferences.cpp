@@ -22,9 +22,8 @@
 */
 
 #include "Preferences.h"
-#include "ui_PrefsDlg.h"
 
-#include <QFileDialog>
+#include <QDir>
 #include <QSettings>
 
 // Saves to ~/Library/Preferences/org.libcinder.TinderBox.plist on Mac OS X
@@ -62,6 +61,10 @@ void Preferences::load()
 	settings.endArray();
 	mOutputPath = settings.value( "outputPath", "" ).toString();
 	mCreateGitRepoDefault = settings.value( "createGitRepoDefault", QVariant( true ) ).toBool();
+	mCopyThreadCount = settings.value( "copyThreadCount", QVariant( 0 ) ).toInt();
+	mBlockCopyMode = copyModeFromString( settings.value( "blockCopyMode", "copy" ).toString() );
+	mAssetCopyMode = copyModeFromString( settings.value( "assetCopyMode", "copy" ).toString() );
+	mCompareCopiedContents = settings.value( "compareCopiedContents", QVariant( false ) ).toBool();
 }
 
 void Preferences::save()
@@ -81,6 +84,10 @@ void Preferences::save()
 	settings.endArray();
 	settings.setValue( "outputPath", mOutputPath );
 	settings.setValue( "createGitRepoDefault", mCreateGitRepoDefault );
+	settings.setValue( "copyThreadCount", mCopyThreadCount );
+	settings.setValue( "blockCopyMode", copyModeToString( mBlockCopyMode ) );
+	settings.setValue( "assetCopyMode", copyModeToString( mAssetCopyMode ) );
+	settings.setValue( "compareCopiedContents", mCompareCopiedContents );
 	settings.sync();
 }
 
@@ -119,65 +126,3 @@ void Preferences::updateCinderVersionInst( size_t index, const QString &name, co
 
 	save();
 }
-
-////////////////////////////////////////////////////////////////////////////////////////////
-// Preferences
-Prefs::Prefs(QWidget *parent)
-: QDialog( parent ),
-  ui( new Ui::Prefs )
-{
-    ui->setupUi(this);
-
-    updateCinderVersionsCtrl();
-}
-
-Prefs::~Prefs()
-{
-    delete ui;
-}
-
-void Prefs::updateCinderVersionsCtrl()
-{
-    // Clear
-    ui->cinderVersions->clear();
-    // Build
-	QList<Preferences::CinderVersion>::const_iterator cit = Preferences::getCinderVersions().begin();
-	for( ; cit != Preferences::getCinderVersions().end(); ++cit ) {
-        QTreeWidgetItem *item = new QTreeWidgetItem( QStringList( cit->name ) );
-        item->setText( 1, cit->path );
-        item->setFlags( item->flags() | Qt::ItemIsEditable );
-        ui->cinderVersions->addTopLevelItem( item );
-    }
-    
-    ui->removeButton->setEnabled( Preferences::getCinderVersions().size() > 1 );
-}
-
-void Prefs::on_addButton_clicked()
-{
-	QFileDialog dirSelDlg( this );
-	dirSelDlg.setFileMode( QFileDialog::Directory );
-	dirSelDlg.setOptions( QFileDialog::ShowDirsOnly | QFileDialog::ReadOnly );
-	if( dirSelDlg.exec() ) {
-		// We should always have one item, if we don't. Something has gone horribly wrong.
-		QStringList items = dirSelDlg.selectedFiles();
-		QDir dir( items[0] );
-		Preferences::addCinderVersion( dir.dirName(), items[0], true );
-
-		updateCinderVersionsCtrl();
-	}
-}
-
-void Prefs::on_removeButton_clicked()
-{
-    QTreeWidgetItem *selItem = ui->cinderVersions->currentItem();
-    if( selItem == NULL )
-		return;
-    Preferences::removeCinderVersion( ui->cinderVersions->indexOfTopLevelItem( selItem ) );
-
-    updateCinderVersionsCtrl();
-}
-
-void Prefs::on_cinderVersions_itemChanged(QTreeWidgetItem *item, int /*column*/ )
-{
-	Preferences::updateCinderVersion( ui->cinderVersions->indexOfTopLevelItem( item ), item->text( 0 ), item->text( 1 ) );
-}
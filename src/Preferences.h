@@ -24,13 +24,9 @@
 #ifndef PREFS_H
 #define PREFS_H
 
-#include <QDialog>
 #include <QMap>
 #include "TinderBox.h"
-
-namespace Ui {
-	class Prefs;
-}
+#include "Util.h"
 
 class Preferences {
   public:
@@ -56,6 +52,19 @@ class Preferences {
 	static bool				getCreateGitRepoDefault() { return get()->mCreateGitRepoDefault; }
 	static void				setCreateGitRepoDefault( bool create ) { get()->mCreateGitRepoDefault = create; get()->save(); }
 
+	// 0 means one thread per core
+	static int				getCopyThreadCount() { return get()->mCopyThreadCount; }
+	static void				setCopyThreadCount( int count ) { get()->mCopyThreadCount = count; get()->save(); }
+
+	// opt-in linking of copied blocks' and assets' files; see CopyMode
+	static CopyMode			getBlockCopyMode() { return get()->mBlockCopyMode; }
+	static void				setBlockCopyMode( CopyMode mode ) { get()->mBlockCopyMode = mode; get()->save(); }
+	static CopyMode			getAssetCopyMode() { return get()->mAssetCopyMode; }
+	static void				setAssetCopyMode( CopyMode mode ) { get()->mAssetCopyMode = mode; get()->save(); }
+	// hash files an overwriting copy would otherwise keep for matching size and mtime
+	static bool				getCompareCopiedContents() { return get()->mCompareCopiedContents; }
+	static void				setCompareCopiedContents( bool compare ) { get()->mCompareCopiedContents = compare; get()->save(); }
+
   private:
 	Preferences() {}
 	static Preferences*	get();
@@ -69,30 +78,9 @@ class Preferences {
 	QList<CinderVersion>		mCinderVersions;
 	QString						mOutputPath;
 	bool						mCreateGitRepoDefault;
-};
-
-class QTreeWidgetItem;
-class Prefs : public QDialog
-{
-    Q_OBJECT
-
-public:
-	explicit Prefs(QWidget *parent = 0);
-    ~Prefs();
-
-private:    
-    Ui::Prefs *ui;
-
-	QList<QPair<QString, Preferences::CinderVersion> >       mCinderVersions;
-
-    void    loadCinderVersionsFromPrefs();
-    void    saveCinderVersionsToPrefs();
-    void    updateCinderVersionsCtrl();
-
-private slots:
-    void on_removeButton_clicked();
-    void on_addButton_clicked();
-	void on_cinderVersions_itemChanged(QTreeWidgetItem *item, int column);
+	int							mCopyThreadCount;
+	CopyMode					mBlockCopyMode, mAssetCopyMode;
+	bool						mCompareCopiedContents;
 };
 
 #endif // PREFS_H
@@ -0,0 +1,87 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "PrefsDlg.h"
+#include "ui_PrefsDlg.h"
+
+#include <QFileDialog>
+
+Prefs::Prefs(QWidget *parent)
+: QDialog( parent ),
+  ui( new Ui::Prefs )
+{
+    ui->setupUi(this);
+
+    updateCinderVersionsCtrl();
+}
+
+Prefs::~Prefs()
+{
+    delete ui;
+}
+
+void Prefs::updateCinderVersionsCtrl()
+{
+    // Clear
+    ui->cinderVersions->clear();
+    // Build
+	QList<Preferences::CinderVersion>::const_iterator cit = Preferences::getCinderVersions().begin();
+	for( ; cit != Preferences::getCinderVersions().end(); ++cit ) {
+        QTreeWidgetItem *item = new QTreeWidgetItem( QStringList( cit->name ) );
+        item->setText( 1, cit->path );
+        item->setFlags( item->flags() | Qt::ItemIsEditable );
+        ui->cinderVersions->addTopLevelItem( item );
+    }
+    
+    ui->removeButton->setEnabled( Preferences::getCinderVersions().size() > 1 );
+}
+
+void Prefs::on_addButton_clicked()
+{
+	QFileDialog dirSelDlg( this );
+	dirSelDlg.setFileMode( QFileDialog::Directory );
+	dirSelDlg.setOptions( QFileDialog::ShowDirsOnly | QFileDialog::ReadOnly );
+	if( dirSelDlg.exec() ) {
+		// We should always have one item, if we don't. Something has gone horribly wrong.
+		QStringList items = dirSelDlg.selectedFiles();
+		QDir dir( items[0] );
+		Preferences::addCinderVersion( dir.dirName(), items[0], true );
+
+		updateCinderVersionsCtrl();
+	}
+}
+
+void Prefs::on_removeButton_clicked()
+{
+    QTreeWidgetItem *selItem = ui->cinderVersions->currentItem();
+    if( selItem == NULL )
+		return;
+    Preferences::removeCinderVersion( ui->cinderVersions->indexOfTopLevelItem( selItem ) );
+
+    updateCinderVersionsCtrl();
+}
+
+void Prefs::on_cinderVersions_itemChanged(QTreeWidgetItem *item, int /*column*/ )
+{
+	Preferences::updateCinderVersion( ui->cinderVersions->indexOfTopLevelItem( item ), item->text( 0 ), item->text( 1 ) );
+}
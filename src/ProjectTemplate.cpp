@@ -31,3 +31,15 @@ ProjectTemplate::ProjectTemplate( const QString &parentPath, const pugi::xml_nod
 	mParentProjectId = doc.attribute( "parent" ).value();
 }
 
+
+ProjectTemplate::ProjectTemplate( TemplateStreamReader &in )
+	: Template( in )
+{
+	mParentProjectId = in.readString();
+}
+
+void ProjectTemplate::write( TemplateStreamWriter &out ) const
+{
+	Template::write( out );
+	out.writeString( mParentProjectId );
+}
@@ -32,6 +32,9 @@ class ProjectTemplate : public Template {
 	{}
 
 	ProjectTemplate( const QString &parentPath, const pugi::xml_node &doc, ErrorList *errors );
+	explicit ProjectTemplate( TemplateStreamReader &in );
+
+	void		write( TemplateStreamWriter &out ) const;
     
     bool		hasParentProject() const { return ! mParentProjectId.isEmpty(); }
     QString		getParentProjectId() const { return mParentProjectId; }
@@ -22,15 +22,15 @@
 */
 
 #include "ProjectTemplateManager.h"
+#include "Trace.h"
 #include "Util.h"
+#include "XmlFile.h"
 
-#include <QApplication>
 #include <QDir>
 #include <QFile>
 #include <QUrl>
 
 #include <iostream>
-#include <fstream>
 
 ProjectTemplateManager*	ProjectTemplateManager::inst()
 {
@@ -46,12 +46,47 @@ ProjectTemplateManager::ProjectTemplateManager()
 
 void ProjectTemplateManager::setCinderDir( QDir cinderDir, ErrorList *errorList )
 {
+	TBOX_TRACE_SCOPE( "ProjectTemplateManager::setCinderDir" );
 	inst()->mCinderDir = cinderDir;
-	inst()->scanImpl( cinderDir, cinderDir.absolutePath() + "/blocks/__AppTemplates", errorList );
+	DirListingCache::Scope listingScope;
+
+	TemplateCache cache( "templates", cinderDir.absolutePath() );
+	cache.load();
+	if( ! cache.reuseDiscovery() ) {
+		QStringList templatePaths;
+		inst()->scanImpl( cinderDir.absolutePath() + "/blocks/__AppTemplates", &templatePaths, &cache );
+		cache.setDiscoveredPaths( templatePaths );
+	}
+
+	// only templates that changed since the last scan are parsed again
+	QList<TemplateCache::Manifest> manifests;
+	QList<bool> reused;
+	{
+		TBOX_TRACE_SCOPE( "ProjectTemplateManager::parseTemplates" );
+		const QStringList &templatePaths = cache.getDiscoveredPaths();
+		for( QStringList::ConstIterator pathIt = templatePaths.begin(); pathIt != templatePaths.end(); ++pathIt ) {
+			TemplateCache::Manifest manifest;
+			reused.push_back( cache.findCurrent( *pathIt, &manifest ) );
+			if( ! reused.back() )
+				manifest = inst()->parseTemplate( cinderDir, *pathIt );
+			manifests.push_back( manifest );
+		}
+	}
+
+	for( int m = 0; m < manifests.size(); ++m ) {
+		cache.addManifest( manifests[m], reused[m] );
+		inst()->mTemplates.append( manifests[m].mProjectTemplates );
+		errorList->mMessages.append( manifests[m].mMessages );
+	}
+	errorList->setActiveFilePath( "" );
+
+	cache.save();
+	inst()->mWatchPaths = cache.getInputPaths();
 }
 
-void ProjectTemplateManager::scanImpl( const QDir &cinderDir, QDir dir, ErrorList *errorList )
+void ProjectTemplateManager::scanImpl( QDir dir, QStringList *templatePaths, TemplateCache *cache )
 {
+	cache->addDir( dir.absolutePath() );
 	if( ! dir.exists() )
 		return;
 	dir.setFilter( QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot );
@@ -60,30 +95,44 @@ void ProjectTemplateManager::scanImpl( const QDir &cinderDir, QDir dir, ErrorLis
 	for (int i = 0; i < list.size(); ++i) {
 		QFileInfo fileInfo = list.at(i);
 		if( fileInfo.isDir() && fileInfo.fileName() != "__Foundation" ) {
-			scanImpl( cinderDir, QDir( fileInfo.filePath() ), errorList );
+			scanImpl( QDir( fileInfo.filePath() ), templatePaths, cache );
 		}
 		else if( fileInfo.fileName() == "template.xml" ) {
-			std::ifstream fs( fileInfo.filePath().toStdString().c_str() );
-			pugi::xml_document doc;
-			pugi::xml_parse_result result = doc.load( fs );
-
-			// set active file path for any reported errors
-			QString relative = cinderDir.relativeFilePath( fileInfo.absoluteFilePath() );
-			errorList->setActiveFilePath( QString( "<a href=\"" ) + QUrl::fromLocalFile( fileInfo.absoluteFilePath() ).toString() + "\">" + relative + "</a>" );
-
-			if( result ) {
-				mTemplates.push_back( ProjectTemplate( dir.absolutePath(), doc.select_single_node( "cinder/template" ).node(), errorList ) );
-			}
-			else {
-				QString msg( "Error parsing template:" + dir.relativeFilePath( fileInfo.filePath() ) );
-				//msg += QString(result.description() + QString::fromAscii(" @ ")) + qPrintable(result.offset);
-				msg += QString(result.description());
-				errorList->addError( msg );
-            }
+			templatePaths->append( fileInfo.absoluteFilePath() );
 		}
 	}
 }
 
+TemplateCache::Manifest ProjectTemplateManager::parseTemplate( const QDir &cinderDir, const QString &path )
+{
+	TemplateCache::Manifest result;
+	result.mPath = path;
+
+	const QFileInfo fileInfo( path );
+	const QDir dir = fileInfo.absoluteDir();
+	result.mStamp = TemplateCache::stamp( fileInfo.absoluteFilePath() );
+	XmlFile xml( fileInfo.absoluteFilePath() );
+	result.mParsed = xml.isLoaded();
+
+	// set active file path for any reported errors
+	ErrorList errorList;
+	QString relative = cinderDir.relativeFilePath( fileInfo.absoluteFilePath() );
+	errorList.setActiveFilePath( QString( "<a href=\"" ) + QUrl::fromLocalFile( fileInfo.absoluteFilePath() ).toString() + "\">" + relative + "</a>" );
+
+	if( xml.isLoaded() ) {
+		result.mProjectTemplates.push_back( ProjectTemplate( dir.absolutePath(), xml.getDocument().select_single_node( "cinder/template" ).node(), &errorList ) );
+		TemplateCache::addPatternDependencies( &result, result.mProjectTemplates.back() );
+	}
+	else {
+		QString msg( "Error parsing template:" + dir.relativeFilePath( fileInfo.filePath() ) );
+		msg += xml.getErrorDescription();
+		errorList.addError( msg );
+	}
+
+	result.mMessages = errorList.mMessages;
+	return result;
+}
+
 QStringList ProjectTemplateManager::getProjectTemplateNamesImpl() const
 {
     QStringList result;
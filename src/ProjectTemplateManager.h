@@ -26,6 +26,7 @@
 #include "TinderBox.h"
 #include "ErrorList.h"
 #include "ProjectTemplate.h"
+#include "TemplateCache.h"
 
 #include <QDir>
 
@@ -34,8 +35,10 @@ class ProjectTemplateManager {
 	static const QList<ProjectTemplate>&	getTemplates() { return inst()->mTemplates; }
 	static QStringList						getProjectTemplateNames() { return inst()->getProjectTemplateNamesImpl(); }
 	
-	static void								clear() { inst()->mTemplates.clear(); }
+	static void								clear() { inst()->mTemplates.clear(); inst()->mWatchPaths.clear(); }
 	static void								setCinderDir( QDir cinderDir, ErrorList *errorList );
+	// the directories and files the last setCinderDir() was derived from; a change to any of them calls for a rescan
+	static const QStringList&				getWatchPaths() { return inst()->mWatchPaths; }
 
 	static QString							getFoundationPath( QString relativePath ) { return inst()->getFoundationPathImpl( relativePath ); }
 	static const ProjectTemplate&			getProjectById( const QString &projectId ) { return inst()->getProjectByIdImpl( projectId ); }
@@ -50,10 +53,12 @@ class ProjectTemplateManager {
 
 	QStringList			getProjectTemplateNamesImpl() const;
 	QString				getFoundationPathImpl( QString relativePath );
-	void				scanImpl( const QDir &cinderDir, QDir dir, ErrorList *errorList );
+	void				scanImpl( QDir dir, QStringList *templatePaths, TemplateCache *cache );
+	TemplateCache::Manifest	parseTemplate( const QDir &cinderDir, const QString &path );
 	
 	const ProjectTemplate&	getProjectByIdImpl( const QString &projectId );
 
 	QDir						mCinderDir;
 	QList<ProjectTemplate>		mTemplates;
+	QStringList					mWatchPaths;
 };
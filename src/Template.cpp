@@ -24,76 +24,146 @@
 #include "Template.h"
 #include "Util.h"
 
+#include <QRegExp>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <cstring>
 #include <iostream>
 
-bool attributeEquals( const pugi::xml_node &node, const std::string &attrName, const std::string &compareValue, bool defaultResult = false )
+namespace {
+
+// ASCII case-insensitive comparison of 'str' against a lower-case literal of the same length
+bool equalsLower( const char *str, const char *lowerLiteral, size_t length )
 {
-	pugi::xml_attribute_iterator attIt = node.attributes_begin();
-	while( attIt != node.attributes_end() ) {
-		if( QString::fromUtf8( attIt->name() ).toLower() == QString::fromUtf8( attrName.c_str() ).toLower() ) {
-			return( QString::fromUtf8( attIt->value()).toLower() == QString::fromUtf8( compareValue.c_str() ).toLower() );
+	for( size_t i = 0; i < length; ++i ) {
+		char c = str[i];
+		if( c >= 'A' && c <= 'Z' )
+			c += 'a' - 'A';
+		if( c != lowerLiteral[i] )
+			return false;
+	}
+	return true;
+}
+
+} // anonymous namespace
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Template::Attributes
+Template::Attributes::Attributes( const pugi::xml_node &node, quint32 known, const QString &tag, ErrorList *errors )
+	: mPresent( 0 )
+{
+	for( pugi::xml_attribute attr = node.first_attribute(); attr; attr = attr.next_attribute() ) {
+		const int id = lookup( attr.name() );
+		if( ( id < 0 || ! ( known & bit( (Id)id ) ) ) && errors )
+			errors->addWarning( "Ignoring unknown attribute \"" + QString::fromUtf8( attr.name() ) + "\" on <" + tag + "> tag." );
+		// the first occurrence of an attribute wins, matching pugi::xml_node::attribute()
+		if( id >= 0 && ! has( (Id)id ) ) {
+			mPresent |= bit( (Id)id );
+			mValues[id] = attr.value();
 		}
-		++attIt;
 	}
+}
 
-	return defaultResult;
+bool Template::Attributes::isTrue( Id id ) const
+{
+	return has( id ) && std::strlen( mValues[id] ) == 4 && equalsLower( mValues[id], "true", 4 );
 }
 
-void testKnownAttributes( const pugi::xml_node &node, const QStringList &knownAttributes, const QString &tag, ErrorList *resultErrors )
+// Maps an attribute name to its Id, ignoring case; returns -1 for unknown names
+int Template::Attributes::lookup( const char *name )
 {
-	pugi::xml_attribute_iterator attIt = node.attributes_begin();
-	while( attIt != node.attributes_end() ) {
-		bool found = false;
-		for( QStringList::ConstIterator knownIt = knownAttributes.constBegin(); knownIt != knownAttributes.constEnd(); ++knownIt ) {
-			if( QString::fromUtf8( attIt->name() ).toLower() == knownIt->toLower() ) {
-				found = true;
-				break;
-			}
-		}
-		if( ! found )
-			resultErrors->addWarning( "Ignoring unknown attribute \"" + QString::fromUtf8( attIt->name() ) + "\" on <" + tag + "> tag." );
-		++attIt;
+	const size_t length = std::strlen( name );
+	switch( length ) {
+		case 2:
+			if( equalsLower( name, "os", 2 ) ) return ATTR_OS;
+			if( equalsLower( name, "id", 2 ) ) return ATTR_ID;
+		break;
+		case 3:
+			if( equalsLower( name, "sdk", 3 ) ) return ATTR_SDK;
+		break;
+		case 4:
+			if( equalsLower( name, "name", 4 ) ) return ATTR_NAME;
+			if( equalsLower( name, "type", 4 ) ) return ATTR_TYPE;
+			if( equalsLower( name, "copy", 4 ) ) return ATTR_COPY;
+			if( equalsLower( name, "core", 4 ) ) return ATTR_CORE;
+		break;
+		case 5:
+			if( equalsLower( name, "ispch", 5 ) ) return ATTR_IS_PCH;
+		break;
+		case 6:
+			if( equalsLower( name, "cinder", 6 ) ) return ATTR_CINDER;
+			if( equalsLower( name, "system", 6 ) ) return ATTR_SYSTEM;
+			if( equalsLower( name, "config", 6 ) ) return ATTR_CONFIG;
+		break;
+		case 8:
+			if( equalsLower( name, "absolute", 8 ) ) return ATTR_ABSOLUTE;
+			if( equalsLower( name, "compiler", 8 ) ) return ATTR_COMPILER;
+		break;
+		case 9:
+			if( equalsLower( name, "compileas", 9 ) ) return ATTR_COMPILE_AS;
+		break;
+		case 11:
+			if( equalsLower( name, "replacename", 11 ) ) return ATTR_REPLACE_NAME;
+			if( equalsLower( name, "destination", 11 ) ) return ATTR_DESTINATION;
+		break;
+		case 12:
+			if( equalsLower( name, "buildexclude", 12 ) ) return ATTR_BUILD_EXCLUDE;
+		break;
+		case 15:
+			if( equalsLower( name, "replacecontents", 15 ) ) return ATTR_REPLACE_CONTENTS;
+		break;
+		case 16:
+			if( equalsLower( name, "isresourceheader", 16 ) ) return ATTR_IS_RESOURCE_HEADER;
+		break;
 	}
+
+	return -1;
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Template::Path
+Template::Path::Path( const QString &path )
+{
+	int separator = path.lastIndexOf( QLatin1Char( '/' ) );
+	if( separator >= 0 ) {
+		mDir = StringPool::intern( path.left( separator + 1 ) );
+		mLeaf = path.mid( separator + 1 );
+	}
+	else
+		mLeaf = path;
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Template::Item
-Template::Item::Item( const QString &parentPath, const QString &inputPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions )
-	: mConditions( conditions )
+Template::Item::Item( const QString &parentPath, const QString &inputPath, const Attributes &attributes, const QMap<QString,QString> &conditions )
+	: mConditions( conditions ), mConditionSetId( -1 )
 {
 	mInputRelativePath = inputPath;
-	mInputAbsolutePath = QDir( parentPath ).absoluteFilePath( mInputRelativePath );
-	mOutputAbsolutePath = "";
-	mOutputIsAbsolute = attributeEquals( dom, "absolute", "true" );
-	mOutputIsSdkRelative = attributeEquals( dom, "sdk", "true" );
-	mOutputIsCinderRelative = attributeEquals( dom, "cinder", "true" );
-	mBuildExclude = attributeEquals( dom, "buildexclude", "true" );
+	mInputAbsolutePath = QDir( parentPath ).absoluteFilePath( inputPath );
+	mOutputIsAbsolute = attributes.isTrue( Attributes::ATTR_ABSOLUTE );
+	mOutputIsSdkRelative = attributes.isTrue( Attributes::ATTR_SDK );
+	mOutputIsCinderRelative = attributes.isTrue( Attributes::ATTR_CINDER );
+	mBuildExclude = attributes.isTrue( Attributes::ATTR_BUILD_EXCLUDE );
 	if( mOutputIsSdkRelative ) {
 		mOutputIsAbsolute = true;
-		mInputRelativePath = "System/Library/Frameworks/" + mInputRelativePath;
+		mInputRelativePath = "System/Library/Frameworks/" + inputPath;
 	}
 }
 
 bool Template::Item::conditionsMatch( const QMap<QString,QString> &conditions ) const
 {
-	for( QMap<QString,QString>::ConstIterator condIt = mConditions.begin(); condIt != mConditions.end(); ++condIt ) {
-		const QString key = condIt.key();
-		const QString val = condIt.value();
-		if( ( ! conditions.contains( condIt.key() ) ) || ( (conditions[condIt.key()] != condIt.value()) && ( conditions[condIt.key()] != "*") ) )
-			return false;
-	}
-
-	return true;
+	return Template::conditionsMatch( mConditions, conditions );
 }
 
-QStringList	Template::Item::knownAttributes()
+quint32 Template::Item::knownAttributes()
 {
-	return QStringList() << "absolute" << "sdk" << "cinder" << "buildexclude";
+	return Attributes::bit( Attributes::ATTR_ABSOLUTE ) | Attributes::bit( Attributes::ATTR_SDK ) | Attributes::bit( Attributes::ATTR_CINDER )
+		| Attributes::bit( Attributes::ATTR_BUILD_EXCLUDE );
 }
 
 QString	Template::Item::getAbsoluteOutputPath() const
 {
-	return mOutputAbsolutePath;
+	return mOutputAbsolutePath.toString();
 }
 
 void Template::Item::setOutputPath( const QString &outputPath, const QString &/*replaceName*/, const QString &cinderPath )
@@ -105,7 +175,7 @@ void Template::Item::setOutputPath( const QString &outputPath, const QString &/*
 	}
 	else if( mOutputIsCinderRelative ) {
 		QDir cinder( cinderPath );
-		mOutputAbsolutePath = cinder.filePath( mInputRelativePath );
+		mOutputAbsolutePath = cinder.filePath( replacedName );
 	}
 	else if( mOutputIsAbsolute || mOutputIsSdkRelative )
 		mOutputAbsolutePath = mInputRelativePath;
@@ -125,71 +195,71 @@ QString Template::Item::getOutputPathRelativeTo( const QString &relativeTo, cons
 		return mInputRelativePath;
 	else {
 		QDir dir( relativeTo );
-		return dir.relativeFilePath( mOutputAbsolutePath );
+		return dir.relativeFilePath( mOutputAbsolutePath.toString() );
 	}
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Template::IncludePath
-Template::IncludePath::IncludePath( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors )
-	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), dom, conditions )
+Template::IncludePath::IncludePath( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions )
+	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), attributes, conditions )
 {
-	mSystem = attributeEquals( dom, "system", "true" );
-
-	testKnownAttributes( dom, Item::knownAttributes() << "system", "includepath", errors );
+	mSystem = attributes.isTrue( Attributes::ATTR_SYSTEM );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Template::LibraryPath
-Template::LibraryPath::LibraryPath( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors )
-	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), dom, conditions )
+Template::LibraryPath::LibraryPath( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions )
+	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), attributes, conditions )
 {
-	testKnownAttributes( dom, Item::knownAttributes(), "librarypath", errors );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Template::FrameworkPath
-Template::FrameworkPath::FrameworkPath( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors )
-	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), dom, conditions )
+Template::FrameworkPath::FrameworkPath( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions )
+	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), attributes, conditions )
 {
-	testKnownAttributes( dom, Item::knownAttributes(), "frameworkpath", errors );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Template::File
-Template::File::File( const QString &parentPath, const QString &inputPath, const pugi::xml_node &dom, Type type, const QMap<QString,QString> &conditions, ErrorList *errors )
-	: Item( parentPath, inputPath, dom, conditions ), mType( type ), mResourceHeader( false ), mPch( false )
+Template::File::File( const QString &parentPath, const QString &inputPath, const Attributes &attributes, Type type, const QMap<QString,QString> &conditions, ErrorList *errors )
+	: Item( parentPath, inputPath, attributes, conditions ), mType( type ), mResourceHeader( false ), mPch( false )
 {
-	mReplaceContents = attributeEquals( dom, "replaceContents", "true" );
-	mReplaceName = attributeEquals( dom, "replaceName", "true" );
+	mReplaceContents = attributes.isTrue( Attributes::ATTR_REPLACE_CONTENTS );
+	mReplaceName = attributes.isTrue( Attributes::ATTR_REPLACE_NAME );
 	// include-specific
-	mPch = attributeEquals( dom, "isPCH", "true" );
-	mResourceHeader = attributeEquals( dom, "isResourceHeader", "true" );
+	mPch = attributes.isTrue( Attributes::ATTR_IS_PCH );
+	mResourceHeader = attributes.isTrue( Attributes::ATTR_IS_RESOURCE_HEADER );
 	// resource-specific
-	mResourceName = QString::fromUtf8( dom.attribute("name").value() );
-	mResourceType = QString::fromUtf8( dom.attribute("type").value() );
-	QString resourceIdString = QString::fromUtf8( dom.attribute("id").value() );
-	if( resourceIdString.isEmpty() || resourceIdString.toLower() == "auto" )
-		mResourceId = -1;
-	else
-		mResourceId = resourceIdString.toInt();
-	mBuildCopyDestination = QString::fromUtf8( dom.attribute("destination").value() );
-	if( mBuildCopyDestination.toLower() != "frameworks" && mBuildCopyDestination.toLower() != "executables" && mBuildCopyDestination.toLower() != "plugins" && ( ! mBuildCopyDestination.isEmpty() ) )
-		errors->addWarning( "Unknown value for destination attribute \"" + mBuildCopyDestination + "\"." );
+	QString resourceName = attributes.value( Attributes::ATTR_NAME );
+	QString resourceType = attributes.value( Attributes::ATTR_TYPE );
+	QString resourceIdString = attributes.value( Attributes::ATTR_ID );
+	int resourceId = -1;
+	if( ! ( resourceIdString.isEmpty() || resourceIdString.toLower() == "auto" ) )
+		resourceId = resourceIdString.toInt();
+	QString buildCopyDestination = attributes.value( Attributes::ATTR_DESTINATION );
+	if( buildCopyDestination.toLower() != "frameworks" && buildCopyDestination.toLower() != "executables" && buildCopyDestination.toLower() != "plugins" && ( ! buildCopyDestination.isEmpty() ) )
+		errors->addWarning( "Unknown value for destination attribute \"" + buildCopyDestination + "\"." );
+	if( ! ( resourceName.isEmpty() && resourceType.isEmpty() && resourceId == -1 && buildCopyDestination.isEmpty() ) ) {
+		mExtra = new Extra;
+		mExtra->mResourceName = resourceName;
+		mExtra->mResourceType = StringPool::intern( resourceType );
+		mExtra->mResourceId = resourceId;
+		mExtra->mBuildCopyDestination = StringPool::intern( buildCopyDestination );
+	}
 
-	mCompileAs = QString::fromUtf8( dom.attribute("compileAs").value() ).toLower();
+	QString relativePath = mInputRelativePath;
+	mCompileAs = attributes.value( Attributes::ATTR_COMPILE_AS ).toLower();
 	if( mCompileAs.isEmpty() )
-		mCompileAs = QFileInfo( mInputRelativePath ).suffix();
+		mCompileAs = QFileInfo( relativePath ).suffix();
+	mCompileAs = StringPool::intern( mCompileAs );
 	if( mOutputIsCinderRelative )
-		mVirtualPath = "Cinder/" + mInputRelativePath;
-	else
-		mVirtualPath = "";
-	
-	QString tagName = QString::fromUtf8( dom.name() ).toLower();
-	testKnownAttributes( dom, Item::knownAttributes() << "replacecontents" << "replacename" << "compileas" << "ispch" << "isresourceheader" << "name" << "type" << "id" << "copy" << "destination", tagName, errors );
+		mVirtualPath = "Cinder/" + relativePath;
+
 	if( ( mType != File::HEADER ) && mPch )
 		errors->addWarning( "Non-header marked as PCH \"" + inputPath + "\"." );
-	if( ( mType != File::BUILD_COPY ) && ( ! mBuildCopyDestination.isEmpty() ) )
+	if( ( mType != File::BUILD_COPY ) && ( ! buildCopyDestination.isEmpty() ) )
 		errors->addWarning( "Non-build copy has \"destination\" attribute." );
 	if( ( mType != File::HEADER ) && mResourceHeader )
 		errors->addWarning( "Non-header marked as Resources header \"" + inputPath + "." );
@@ -197,21 +267,38 @@ Template::File::File( const QString &parentPath, const QString &inputPath, const
 		errors->addWarning( "Ignoring \"sdk\" on " + inputPath + "." );
 }
 
+quint32 Template::File::knownAttributes()
+{
+	return Item::knownAttributes() | Attributes::bit( Attributes::ATTR_REPLACE_CONTENTS ) | Attributes::bit( Attributes::ATTR_REPLACE_NAME )
+		| Attributes::bit( Attributes::ATTR_COMPILE_AS ) | Attributes::bit( Attributes::ATTR_IS_PCH ) | Attributes::bit( Attributes::ATTR_IS_RESOURCE_HEADER )
+		| Attributes::bit( Attributes::ATTR_NAME ) | Attributes::bit( Attributes::ATTR_TYPE ) | Attributes::bit( Attributes::ATTR_ID )
+		| Attributes::bit( Attributes::ATTR_COPY ) | Attributes::bit( Attributes::ATTR_DESTINATION );
+}
+
 void Template::File::setInputPath( const QString &parentPath, const QString &inputPath )
 {
-	mInputRelativePath = inputPath;
-	mInputAbsolutePath = QDir( parentPath ).absoluteFilePath( mInputRelativePath );
+	QString relativePath = inputPath;
+	mInputAbsolutePath = QDir( parentPath ).absoluteFilePath( inputPath );
 	if( mOutputIsSdkRelative ) {
-		mInputRelativePath = "System/Library/Frameworks/" + mInputRelativePath;
+		relativePath = "System/Library/Frameworks/" + relativePath;
 	}
+	mInputRelativePath = relativePath;
 
 	if( mOutputIsCinderRelative )
-		mVirtualPath = "Cinder/" + mInputRelativePath;
+		mVirtualPath = "Cinder/" + relativePath;
+}
+
+void Template::File::setResourceId( int id )
+{
+	if( ! mExtra )
+		mExtra = new Extra;
+	mExtra->mResourceId = id;
 }
 
 void Template::File::setOutputPath( const QString &outputPath, const QString &replaceName, const QString &cinderPath )
 {
-	QString replacedName = mInputRelativePath;
+	QString relativePath = mInputRelativePath;
+	QString replacedName = relativePath;
 	if( mReplaceName ) {
 		replacedName.replace( "_TBOX_PREFIX_", replaceName );
 	}
@@ -221,10 +308,10 @@ void Template::File::setOutputPath( const QString &outputPath, const QString &re
 	}
 	else if( mOutputIsCinderRelative ) {
 		QDir cinder( cinderPath );
-		mOutputAbsolutePath = cinder.filePath( mInputRelativePath );
+		mOutputAbsolutePath = cinder.filePath( relativePath );
 	}
 	else if( mOutputIsAbsolute || mOutputIsSdkRelative )
-		mOutputAbsolutePath = mInputRelativePath;
+		mOutputAbsolutePath = relativePath;
 	else {
 		QDir dir( outputPath );
 		mOutputAbsolutePath = dir.absoluteFilePath( replacedName );
@@ -252,43 +339,39 @@ QString	Template::File::getMacOutputPath( const QString &outputPath, const QStri
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Template::StaticLibrary
-Template::StaticLibrary::StaticLibrary( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors )
-	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), dom, conditions )
+Template::StaticLibrary::StaticLibrary( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions )
+	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), attributes, conditions )
 {
-	testKnownAttributes( dom, Item::knownAttributes(), "staticlibrary", errors );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Template::DynamicLibrary
-Template::DynamicLibrary::DynamicLibrary( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors )
-	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), dom, conditions )
+Template::DynamicLibrary::DynamicLibrary( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions )
+	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), attributes, conditions )
 {
-	testKnownAttributes( dom, Item::knownAttributes(), "dynamiclibrary", errors );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Template::BuildSetting
-Template::BuildSetting::BuildSetting( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors )
-	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), dom, conditions )
+Template::BuildSetting::BuildSetting( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions )
+	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), attributes, conditions )
 {
-	mKey = QString::fromUtf8( dom.attribute("name").value() );
+	mKey = attributes.value( Attributes::ATTR_NAME );
 	mValue = QString::fromUtf8( dom.first_child().value() );
-	
-	testKnownAttributes( dom, QStringList() << "name", "setting", errors );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Template::PreprocessorDefine
-Template::PreprocessorDefine::PreprocessorDefine( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors )
-	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), dom, conditions )
+Template::PreprocessorDefine::PreprocessorDefine( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions )
+	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), attributes, conditions )
 {
 	mValue = QString::fromUtf8( dom.first_child().value() );
 }
 
 //////////////////////////////////////////////////////////////////////////////////////////////
 // Template::OutputExtension
-Template::OutputExtension::OutputExtension( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors )
-	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), dom, conditions )
+Template::OutputExtension::OutputExtension( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions )
+	: Item( parentPath, QString::fromUtf8( dom.first_child().value() ), attributes, conditions )
 {
 	mValue = QString::fromUtf8( dom.first_child().value() );
 }
@@ -298,30 +381,104 @@ Template::OutputExtension::OutputExtension( const QString &parentPath, const pug
 Template::Template( const QString &parentPath, const pugi::xml_node &doc, ErrorList *errors )
 	: mParentPath( parentPath ), mCore( false )
 {
+	parseBody( doc, errors );
+}
+
+void Template::parseHeader( const pugi::xml_node &doc )
+{
+	mId = QString::fromUtf8( doc.attribute( "id" ).value() );
+	mName = doc.attribute( "name" ).value();
+	mCore = Attributes( doc, Attributes::ALL, "", NULL ).isTrue( Attributes::ATTR_CORE );
+	parseHeaderGroup( doc );
+}
+
+// Mirrors parseGroup() for only <requires> and <supports>; warnings are left for parseBody() to report
+void Template::parseHeaderGroup( const pugi::xml_node &node )
+{
+	for( pugi::xml_node targetNode = node.first_child(); targetNode; targetNode = targetNode.next_sibling() ) {
+		QString tagName = QString::fromUtf8( targetNode.name() ).toLower();
+		if( tagName == "requires" )
+			mRequires.push_back( QString::fromUtf8( targetNode.first_child().value() ) );
+		else if( tagName == "platform" )
+			parseHeaderGroup( targetNode );
+		else if( tagName == "supports" )
+			parseSupports( targetNode, NULL );
+	}
+}
+
+void Template::parseBody( const pugi::xml_node &doc, ErrorList *errors )
+{
+	mRequires.clear();
+	mSupports.clear();
+	mPatternDirs.clear();
+
 	QMap<QString,QString> emptyConditions;
 	mId = QString::fromUtf8( doc.attribute( "id" ).value() );
 	parseGroup( doc, emptyConditions, errors );
+	expandFilePatterns();
+	indexConditionSets();
 }
 
-// Converts a <sourcePattern> or <headerPattern> into a group of <source> or <header> files
-void Template::processFilePattern( const QString &parentPath, const pugi::xml_node &dom, File::Type type, const QMap<QString,QString> &conditions, ErrorList *errors )
+// Converts a <sourcePattern> or <headerPattern> into a group of <source> or <header> files; see expandFilePatterns()
+void Template::processFilePattern( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, File::Type type, const QMap<QString,QString> &conditions, ErrorList *errors )
 {
 	// Create a temporary Template::File to extract the attributes and data
-	Template::File tempFile( parentPath, QString::fromUtf8( dom.first_child().value() ), dom, type, conditions, errors );
+	Template::File tempFile( parentPath, QString::fromUtf8( dom.first_child().value() ), attributes, type, conditions, errors );
+	mPendingPatterns.push_back( PendingPattern( mFiles.size(), parentPath, tempFile ) );
+}
+
+void Template::expandFilePatterns()
+{
+	if( mPendingPatterns.isEmpty() )
+		return;
+
+	// share the listings of the current scan if there is one
+	DirListingCache localCache;
+	DirListingCache *cache = DirListingCache::current() ? DirListingCache::current() : &localCache;
+	for( QList<PendingPattern>::Iterator patternIt = mPendingPatterns.begin(); patternIt != mPendingPatterns.end(); ++patternIt )
+		patternIt->mCache = cache;
+
+	if( mPendingPatterns.size() > 1 )
+		QtConcurrent::blockingMap( mPendingPatterns, &Template::expandFilePattern );
+	else
+		expandFilePattern( mPendingPatterns.first() );
+
+	// splice the matches in at the position each pattern was declared
+	QList<File> files;
+	files.reserve( mFiles.size() );
+	QList<PendingPattern>::ConstIterator patternIt = mPendingPatterns.constBegin();
+	for( int i = 0; i <= mFiles.size(); ++i ) {
+		for( ; patternIt != mPendingPatterns.constEnd() && patternIt->mIndex == i; ++patternIt ) {
+			for( QStringList::ConstIterator sIt = patternIt->mMatches.constBegin(); sIt != patternIt->mMatches.constEnd(); ++sIt ) {
+				files.push_back( patternIt->mPrototype );
+				files.back().setInputPath( patternIt->mParentPath, *sIt );
+			}
+		}
+		if( i < mFiles.size() )
+			files.push_back( mFiles[i] );
+	}
+	mFiles = files;
+
+	for( QList<PendingPattern>::ConstIterator patternIt = mPendingPatterns.constBegin(); patternIt != mPendingPatterns.constEnd(); ++patternIt )
+		mPatternDirs.append( patternIt->mListedDirs );
+	mPatternDirs.removeDuplicates();
 
-	QList<File> result;
-	QString pathPart = QFileInfo( tempFile.getRelativeInputPath() ).path(); // Ex: Box2D/src/Box2D/Rope
-	QString namePart = QFileInfo( tempFile.getRelativeInputPath() ).fileName(); // Ex: *.cpp
+	mPendingPatterns.clear();
+}
 
-	QDir dir( QDir( parentPath ).absoluteFilePath( pathPart ) );
-	// use the namePart as a regex-style filter
-	dir.setNameFilters( QStringList() << namePart );
-	dir.setFilter( QDir::NoDotAndDotDot | QDir::Files );
-	QStringList entries = dir.entryList();
-	for( QStringList::Iterator sIt = entries.begin(); sIt != entries.end(); ++sIt ) {
-		mFiles.push_back( tempFile );
-		mFiles.back().setInputPath( parentPath, QDir( pathPart ).filePath( *sIt ) );
+void Template::expandFilePattern( PendingPattern &pattern )
+{
+	QString relativePath = pattern.mPrototype.getRelativeInputPath(); // Ex: Box2D/src/Box2D/**/*.cpp
+	QString pathPart = QFileInfo( relativePath ).path(); // Ex: Box2D/src/Box2D/Rope
+	QStringList matches = pattern.mCache->glob( pattern.mParentPath, relativePath, &pattern.mListedDirs );
+
+	// a pattern with a literal directory keeps that directory as written, ie "./Foo.cpp"
+	if( ! pathPart.contains( QRegExp( "[*?\\[]" ) ) ) {
+		for( QStringList::Iterator sIt = matches.begin(); sIt != matches.end(); ++sIt )
+			*sIt = QDir( pathPart ).filePath( QFileInfo( *sIt ).fileName() );
 	}
+
+	pattern.mMatches = matches;
 }
 
 void Template::parseGroup( const pugi::xml_node &node, QMap<QString,QString> conditions, ErrorList *errors )
@@ -330,14 +487,17 @@ void Template::parseGroup( const pugi::xml_node &node, QMap<QString,QString> con
 
 	if( tagName == "template" || tagName == "block" ) {
 		mName = node.attribute( "name" ).value();
-		mCore = attributeEquals( node, "core", "true" );
+		mCore = Attributes( node, Attributes::ALL, tagName, NULL ).isTrue( Attributes::ATTR_CORE );
 	}
 	// with a platform node we need to parse compiler & os
 	else if( tagName == QString("platform") ) {
-		QString compiler = QString::fromUtf8( node.attribute("compiler").value() ).toLower();
-		QString os = QString::fromUtf8( node.attribute("os").value() ).toLower();
-		QString config = QString::fromUtf8( node.attribute("config").value() ).toLower();
-		QString sdk = QString::fromUtf8( node.attribute("sdk").value() ).toLower();
+		const quint32 known = Attributes::bit( Attributes::ATTR_COMPILER ) | Attributes::bit( Attributes::ATTR_OS )
+			| Attributes::bit( Attributes::ATTR_CONFIG ) | Attributes::bit( Attributes::ATTR_SDK );
+		Attributes attributes( node, known, "platform", errors );
+		QString compiler = attributes.value( Attributes::ATTR_COMPILER ).toLower();
+		QString os = attributes.value( Attributes::ATTR_OS ).toLower();
+		QString config = attributes.value( Attributes::ATTR_CONFIG ).toLower();
+		QString sdk = attributes.value( Attributes::ATTR_SDK ).toLower();
 		if( ! compiler.isEmpty() )
 			conditions["compiler"] = compiler;
 		if( ! os.isEmpty() )
@@ -346,8 +506,6 @@ void Template::parseGroup( const pugi::xml_node &node, QMap<QString,QString> con
 			conditions["config"] = config;
 		if( ! sdk.isEmpty() )
 			conditions["sdk"] = sdk;
-			
-		testKnownAttributes( node, QStringList() << "compiler" << "os" << "config" << "sdk", "platform", errors );				
 	}
 
 	// iterate the children
@@ -355,59 +513,59 @@ void Template::parseGroup( const pugi::xml_node &node, QMap<QString,QString> con
 	while( targetNode ) {
 		QString tagName = QString::fromUtf8( targetNode.name() ).toLower();
 		if( tagName == "source" ) {
-			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), targetNode, File::SOURCE, conditions, errors ) );
+			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), Attributes( targetNode, File::knownAttributes(), tagName, errors ), File::SOURCE, conditions, errors ) );
 		}
 		else if( tagName == "sourcepattern" ) {
-			processFilePattern( mParentPath, targetNode, File::SOURCE, conditions, errors );
+			processFilePattern( mParentPath, targetNode, Attributes( targetNode, File::knownAttributes(), tagName, errors ), File::SOURCE, conditions, errors );
 		}
 		else if( tagName == "header" ) {
-			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), targetNode, File::HEADER, conditions, errors ) );
+			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), Attributes( targetNode, File::knownAttributes(), tagName, errors ), File::HEADER, conditions, errors ) );
 		}
 		else if( tagName == "headerpattern" ) {
-			processFilePattern( mParentPath, targetNode, File::HEADER, conditions, errors );
+			processFilePattern( mParentPath, targetNode, Attributes( targetNode, File::knownAttributes(), tagName, errors ), File::HEADER, conditions, errors );
 		}
 		else if( tagName == "resource" ) {
-			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), targetNode, File::RESOURCE, conditions, errors ) );
+			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), Attributes( targetNode, File::knownAttributes(), tagName, errors ), File::RESOURCE, conditions, errors ) );
 		}
 		else if( tagName == "asset" ) {
-			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), targetNode, File::ASSET, conditions, errors ) );
+			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), Attributes( targetNode, File::knownAttributes(), tagName, errors ), File::ASSET, conditions, errors ) );
 		}
 		else if( tagName == "framework" ) {
-			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), targetNode, File::FRAMEWORK, conditions, errors ) );
+			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), Attributes( targetNode, File::knownAttributes(), tagName, errors ), File::FRAMEWORK, conditions, errors ) );
 		}
 		else if( tagName == "buildcopy" ) {
-			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), targetNode, File::BUILD_COPY, conditions, errors ) );
+			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), Attributes( targetNode, File::knownAttributes(), tagName, errors ), File::BUILD_COPY, conditions, errors ) );
 		}
 		/*
 		else if( tagName == "directory" ) {
 			mFiles.push_back( File( mParentPath, targetNode, File::DIRECTORY, conditions ) );
 		}*/
 		else if( tagName == "file" ) {
-			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), targetNode, File::FILE, conditions, errors ) );
+			mFiles.push_back( File( mParentPath, QString::fromUtf8( targetNode.first_child().value() ), Attributes( targetNode, File::knownAttributes(), tagName, errors ), File::FILE, conditions, errors ) );
 		}
 		else if( tagName == "staticlibrary" ) {
-			mStaticLibraries.push_back( StaticLibrary( mParentPath, targetNode, conditions, errors ) );
+			mStaticLibraries.push_back( StaticLibrary( mParentPath, targetNode, Attributes( targetNode, StaticLibrary::knownAttributes(), tagName, errors ), conditions ) );
 		}
 		else if( tagName == "dynamiclibrary" ) {
-			mDynamicLibraries.push_back( DynamicLibrary( mParentPath, targetNode, conditions, errors ) );
+			mDynamicLibraries.push_back( DynamicLibrary( mParentPath, targetNode, Attributes( targetNode, DynamicLibrary::knownAttributes(), tagName, errors ), conditions ) );
 		}
 		else if( tagName == "includepath" ) {
-			mIncludePaths.push_back( IncludePath( mParentPath, targetNode, conditions, errors ) );
+			mIncludePaths.push_back( IncludePath( mParentPath, targetNode, Attributes( targetNode, IncludePath::knownAttributes(), tagName, errors ), conditions ) );
 		}
 		else if( tagName == "librarypath" ) {
-			mLibraryPaths.push_back( LibraryPath( mParentPath, targetNode, conditions, errors ) );
+			mLibraryPaths.push_back( LibraryPath( mParentPath, targetNode, Attributes( targetNode, LibraryPath::knownAttributes(), tagName, errors ), conditions ) );
 		}
 		else if( tagName == "frameworkpath" ) {
-			mFrameworkPaths.push_back( FrameworkPath( mParentPath, targetNode, conditions, errors ) );
+			mFrameworkPaths.push_back( FrameworkPath( mParentPath, targetNode, Attributes( targetNode, FrameworkPath::knownAttributes(), tagName, errors ), conditions ) );
 		}
 		else if( tagName == "setting" ) {
-			mBuildSettings.push_back( BuildSetting( mParentPath, targetNode, conditions, errors ) );
+			mBuildSettings.push_back( BuildSetting( mParentPath, targetNode, Attributes( targetNode, BuildSetting::knownAttributes(), tagName, errors ), conditions ) );
 		}
 		else if( tagName == "preprocessordefine" ) {
-			mPreprocessorDefines.push_back( PreprocessorDefine( mParentPath, targetNode, conditions, errors ) );
+			mPreprocessorDefines.push_back( PreprocessorDefine( mParentPath, targetNode, Attributes( targetNode, Attributes::ALL, tagName, NULL ), conditions ) );
 		}
 		else if( tagName == "outputextension" ) {
-			mOutputExtensions.push_back( OutputExtension( mParentPath, targetNode, conditions, errors ) );
+			mOutputExtensions.push_back( OutputExtension( mParentPath, targetNode, Attributes( targetNode, Attributes::ALL, tagName, NULL ), conditions ) );
 		}
 		else if( tagName == "requires" ) {
 			mRequires.push_back( QString::fromUtf8( targetNode.first_child().value() ) );
@@ -428,17 +586,13 @@ void Template::parseGroup( const pugi::xml_node &node, QMap<QString,QString> con
 
 void Template::parseSupports( const pugi::xml_node &node, ErrorList *errors )
 {
+	Attributes attributes( node, Attributes::bit( Attributes::ATTR_OS ) | Attributes::bit( Attributes::ATTR_COMPILER ), "supports", errors );
+
 	QMap<QString,QString> conditions;
-	if( ! node.attribute( "os" ).empty() ) {
-		QString os = QString::fromUtf8( node.attribute("os").value() ).toLower();
-		conditions["os"] = os;
-	}
-	if( ! node.attribute( "compiler" ).empty() ) {
-		QString compiler = QString::fromUtf8( node.attribute("compiler").value() ).toLower();
-		conditions["compiler"] = compiler;
-	}
-	
-	testKnownAttributes( node, QStringList() << "os" << "compiler", "supports", errors );
+	if( attributes.has( Attributes::ATTR_OS ) )
+		conditions["os"] = attributes.value( Attributes::ATTR_OS ).toLower();
+	if( attributes.has( Attributes::ATTR_COMPILER ) )
+		conditions["compiler"] = attributes.value( Attributes::ATTR_COMPILER ).toLower();
 
 	mSupports.push_back( conditions );
 }
@@ -450,6 +604,7 @@ void Template::setOutputPathToInput()
 
 void Template::setOutputPath( const QString &outputPath, const QString &replaceName, const QString &cinderPath )
 {
+	mQueryCache.clear();
 	mOutputPath = outputPath;
 	mReplacementPrefix = replaceName;
 	mCinderPath = cinderPath;
@@ -475,6 +630,7 @@ void Template::setOutputPath( const QString &outputPath, const QString &replaceN
 
 void Template::setupVirtualPaths( const QString &virtualPath )
 {
+	mQueryCache.clear();
 	// generate all the files
     for( QList<File>::Iterator fileIt = mFiles.begin(); fileIt != mFiles.end(); ++fileIt ) {
 		if( ! fileIt->isOutputSdkRelative() ) {
@@ -506,13 +662,25 @@ bool Template::supportsConditions( const QMap<QString,QString> &conditions ) con
 	return false;
 }
 
-void Template::instantiateFilesMatchingConditions( const QList<QMap<QString,QString> > &conditionsList, bool overwriteExisting ) const
+// Returns true when every condition an item was declared under is present in 'conditions', either verbatim or as "*"
+bool Template::conditionsMatch( const QMap<QString,QString> &itemConditions, const QMap<QString,QString> &conditions )
+{
+	for( QMap<QString,QString>::ConstIterator condIt = itemConditions.begin(); condIt != itemConditions.end(); ++condIt ) {
+		QMap<QString,QString>::ConstIterator testIt = conditions.find( condIt.key() );
+		if( ( testIt == conditions.end() ) || ( ( testIt.value() != condIt.value() ) && ( testIt.value() != "*" ) ) )
+			return false;
+	}
+
+	return true;
+}
+
+void Template::instantiateFilesMatchingConditions( const QList<QMap<QString,QString> > &conditionsList, bool overwriteExisting, CopyPlan *plan, CopyMode mode, bool compareContents ) const
 {
 	// files
 	for( QList<File>::ConstIterator fileIt = mFiles.begin(); fileIt != mFiles.end(); ++fileIt ) {
 		for( QList<QMap<QString,QString> >::ConstIterator conditionsIt = conditionsList.begin(); conditionsIt != conditionsList.end(); ++conditionsIt ) {
 			if( fileIt->shouldCopy() && fileIt->conditionsMatch( *conditionsIt ) ) {
-				copyFileOrDir( fileIt->getAbsoluteInputPath(), fileIt->getAbsoluteOutputPath(), overwriteExisting, fileIt->getReplaceContents(), mReplacementPrefix, false );
+				plan->add( fileIt->getAbsoluteInputPath(), fileIt->getAbsoluteOutputPath(), overwriteExisting, fileIt->getReplaceContents(), mReplacementPrefix, false, mode, compareContents );
 				break;
 			}
 		}
@@ -522,7 +690,7 @@ void Template::instantiateFilesMatchingConditions( const QList<QMap<QString,QStr
 	for( QList<IncludePath>::ConstIterator pathIt = mIncludePaths.begin(); pathIt != mIncludePaths.end(); ++pathIt ) {
 		for( QList<QMap<QString,QString> >::ConstIterator conditionsIt = conditionsList.begin(); conditionsIt != conditionsList.end(); ++conditionsIt ) {
 			if( pathIt->shouldCopy() && pathIt->conditionsMatch( *conditionsIt ) ) {
-				copyFileOrDir( pathIt->getAbsoluteInputPath(), pathIt->getAbsoluteOutputPath(), overwriteExisting );
+				plan->add( pathIt->getAbsoluteInputPath(), pathIt->getAbsoluteOutputPath(), overwriteExisting, false, "", false, mode, compareContents );
 				break;
 			}
 		}
@@ -532,7 +700,7 @@ void Template::instantiateFilesMatchingConditions( const QList<QMap<QString,QStr
 	for( QList<DynamicLibrary>::ConstIterator libIt = mDynamicLibraries.begin(); libIt != mDynamicLibraries.end(); ++libIt ) {
 		for( QList<QMap<QString,QString> >::ConstIterator conditionsIt = conditionsList.begin(); conditionsIt != conditionsList.end(); ++conditionsIt ) {
 			if( libIt->shouldCopy() && libIt->conditionsMatch( *conditionsIt ) ) {
-				copyFileOrDir( libIt->getAbsoluteInputPath(), libIt->getAbsoluteOutputPath(), overwriteExisting );
+				plan->add( libIt->getAbsoluteInputPath(), libIt->getAbsoluteOutputPath(), overwriteExisting, false, "", false, mode, compareContents );
 				break;
 			}
 		}
@@ -542,92 +710,367 @@ void Template::instantiateFilesMatchingConditions( const QList<QMap<QString,QStr
 	for( QList<StaticLibrary>::ConstIterator libIt = mStaticLibraries.begin(); libIt != mStaticLibraries.end(); ++libIt ) {
 		for( QList<QMap<QString,QString> >::ConstIterator conditionsIt = conditionsList.begin(); conditionsIt != conditionsList.end(); ++conditionsIt ) {
 			if( libIt->shouldCopy() && libIt->conditionsMatch( *conditionsIt ) ) {
-				copyFileOrDir( libIt->getAbsoluteInputPath(), libIt->getAbsoluteOutputPath(), overwriteExisting );
+				plan->add( libIt->getAbsoluteInputPath(), libIt->getAbsoluteOutputPath(), overwriteExisting, false, "", false, mode, compareContents );
 				break;
 			}
 		}
 	}
 }
 
-QList<Template::File> Template::getFilesMatchingConditions( const QMap<QString,QString> &conditions ) const
+Template::ItemRefs<Template::File> Template::getFilesMatchingConditions( const QMap<QString,QString> &conditions ) const
 {
-	QList<File> result;
+	return getItemsMatchingConditions<File>( mFiles, mQueryCache.mFiles, QList<QMap<QString,QString> >() << conditions );
+}
 
-	for( QList<File>::ConstIterator fileIt = mFiles.begin(); fileIt != mFiles.end(); ++fileIt ) {
-		if( fileIt->conditionsMatch( conditions ) ) {
-			result.push_back( *fileIt );
+Template::ItemRefs<Template::File> Template::getFilesMatchingConditions( const QList<QMap<QString,QString> > &conditionsList ) const
+{
+	return getItemsMatchingConditions<File>( mFiles, mQueryCache.mFiles, conditionsList );
+}
+
+template<typename T>
+Template::ItemRefs<T> Template::getItemsMatchingConditions( const QList<T> &list, QMap<QString,ItemRefs<T> > &cache, const QList<QMap<QString,QString> > &conditionsList ) const
+{
+	const QString signature = conditionsSignature( conditionsList );
+	typename QMap<QString,ItemRefs<T> >::ConstIterator cachedIt = cache.constFind( signature );
+	if( cachedIt != cache.constEnd() )
+		return cachedIt.value();
+
+	// test each distinct condition set once rather than every item's conditions
+	const QVector<bool> setMatches = matchConditionSets( conditionsList );
+
+	ItemRefs<T> result;
+	for( typename QList<T>::ConstIterator itemIt = list.constBegin(); itemIt != list.constEnd(); ++itemIt ) {
+		bool matched = false;
+		if( itemIt->mConditionSetId >= 0 && itemIt->mConditionSetId < setMatches.size() )
+			matched = setMatches[itemIt->mConditionSetId];
+		else { // not indexed; fall back to testing the item directly
+			for( QList<QMap<QString,QString> >::ConstIterator condIt = conditionsList.begin(); condIt != conditionsList.end() && ! matched; ++condIt )
+				matched = itemIt->conditionsMatch( *condIt );
 		}
+		if( matched )
+			result.push_back( &(*itemIt) );
 	}
 
+	cache.insert( signature, result );
 	return result;
 }
 
-QList<Template::File> Template::getFilesMatchingConditions( const QList<QMap<QString,QString> > &conditionsList ) const
+Template::ItemRefs<Template::IncludePath> Template::getIncludePathsMatchingConditions( const QMap<QString,QString> &conditions ) const
+{
+	return getItemsMatchingConditions<IncludePath>( mIncludePaths, mQueryCache.mIncludePaths, QList<QMap<QString,QString> >() << conditions );
+}
+
+Template::ItemRefs<Template::LibraryPath> Template::getLibraryPathsMatchingConditions( const QMap<QString,QString> &conditions ) const
+{
+	return getItemsMatchingConditions<LibraryPath>( mLibraryPaths, mQueryCache.mLibraryPaths, QList<QMap<QString,QString> >() << conditions );
+}
+
+Template::ItemRefs<Template::FrameworkPath> Template::getFrameworkPathsMatchingConditions( const QMap<QString,QString> &conditions ) const
+{
+	return getItemsMatchingConditions<FrameworkPath>( mFrameworkPaths, mQueryCache.mFrameworkPaths, QList<QMap<QString,QString> >() << conditions );
+}
+
+Template::ItemRefs<Template::StaticLibrary> Template::getStaticLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const
+{
+	return getItemsMatchingConditions<StaticLibrary>( mStaticLibraries, mQueryCache.mStaticLibraries, QList<QMap<QString,QString> >() << conditions );
+}
+
+Template::ItemRefs<Template::DynamicLibrary> Template::getDynamicLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const
+{
+	return getItemsMatchingConditions<DynamicLibrary>( mDynamicLibraries, mQueryCache.mDynamicLibraries, QList<QMap<QString,QString> >() << conditions );
+}
+
+Template::ItemRefs<Template::BuildSetting> Template::getBuildSettingsMatchingConditions( const QMap<QString,QString> &conditions ) const
+{
+	return getItemsMatchingConditions<BuildSetting>( mBuildSettings, mQueryCache.mBuildSettings, QList<QMap<QString,QString> >() << conditions );
+}
+
+Template::ItemRefs<Template::PreprocessorDefine> Template::getPreprocessorDefinesMatchingConditions( const QMap<QString,QString> &conditions ) const
 {
-    QList<File> result;
+	return getItemsMatchingConditions<PreprocessorDefine>( mPreprocessorDefines, mQueryCache.mPreprocessorDefines, QList<QMap<QString,QString> >() << conditions );
+}
 
-    for( QList<File>::ConstIterator fileIt = mFiles.begin(); fileIt != mFiles.end(); ++fileIt ) {
-        for( QList<QMap<QString,QString> >::ConstIterator conditionsIt = conditionsList.begin(); conditionsIt != conditionsList.end(); ++conditionsIt ) {
-            if( fileIt->conditionsMatch( *conditionsIt ) ) {
-                result.push_back( *fileIt );
-                break;
-            }
-        }
-    }
+Template::ItemRefs<Template::OutputExtension> Template::getOutputExtensionsMatchingConditions( const QMap<QString,QString> &conditions ) const
+{
+	return getItemsMatchingConditions<OutputExtension>( mOutputExtensions, mQueryCache.mOutputExtensions, QList<QMap<QString,QString> >() << conditions );
+}
 
-    return result;
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Condition set indexing
+void Template::indexConditionSets()
+{
+	mConditionSets.clear();
+	mConditionSetIds.clear();
+	mQueryCache.clear();
+
+	indexConditionSets<File>( mFiles );
+	indexConditionSets<IncludePath>( mIncludePaths );
+	indexConditionSets<LibraryPath>( mLibraryPaths );
+	indexConditionSets<FrameworkPath>( mFrameworkPaths );
+	indexConditionSets<StaticLibrary>( mStaticLibraries );
+	indexConditionSets<DynamicLibrary>( mDynamicLibraries );
+	indexConditionSets<BuildSetting>( mBuildSettings );
+	indexConditionSets<PreprocessorDefine>( mPreprocessorDefines );
+	indexConditionSets<OutputExtension>( mOutputExtensions );
 }
 
 template<typename T>
-QList<T> Template::getItemsMatchingConditions( const QList<T> &list, const QMap<QString,QString> &conditions ) const
+void Template::indexConditionSets( QList<T> &list )
 {
-	QList<T> result;
+	// items parsed from the same group share their QMap's data, so consecutive items rarely need a signature built
+	int lastId = -1;
+	for( typename QList<T>::Iterator itemIt = list.begin(); itemIt != list.end(); ++itemIt ) {
+		if( lastId < 0 || ! itemIt->mConditions.isSharedWith( mConditionSets[lastId] ) ) {
+			lastId = registerConditionSet( itemIt->mConditions );
+			// equal sets declared apart (or decoded separately) collapse to one shared copy
+			itemIt->mConditions = mConditionSets[lastId];
+		}
+		itemIt->mConditionSetId = lastId;
+	}
+}
+
+int Template::registerConditionSet( const QMap<QString,QString> &conditions )
+{
+	const QString signature = conditionsSignature( conditions );
+	QMap<QString,int>::ConstIterator idIt = mConditionSetIds.constFind( signature );
+	if( idIt != mConditionSetIds.constEnd() )
+		return idIt.value();
+
+	mConditionSets.push_back( conditions );
+	mConditionSetIds.insert( signature, mConditionSets.size() - 1 );
+	return mConditionSets.size() - 1;
+}
 
-	for( typename QList<T>::ConstIterator fileIt = list.begin(); fileIt != list.end(); ++fileIt ) {
-		if( fileIt->conditionsMatch( conditions ) ) {
-			result.push_back( *fileIt );
+// Returns, for each of our condition sets, whether it matches any member of 'conditionsList'
+QVector<bool> Template::matchConditionSets( const QList<QMap<QString,QString> > &conditionsList ) const
+{
+	QVector<bool> result( mConditionSets.size(), false );
+	for( int s = 0; s < mConditionSets.size(); ++s ) {
+		for( QList<QMap<QString,QString> >::ConstIterator condIt = conditionsList.begin(); condIt != conditionsList.end(); ++condIt ) {
+			if( conditionsMatch( mConditionSets[s], *condIt ) ) {
+				result[s] = true;
+				break;
+			}
 		}
 	}
 
-	return result;  
+	return result;
+}
+
+QString Template::conditionsSignature( const QMap<QString,QString> &conditions )
+{
+	// QMap iterates in key order, so equal maps always produce equal signatures
+	QString result;
+	for( QMap<QString,QString>::ConstIterator condIt = conditions.begin(); condIt != conditions.end(); ++condIt )
+		result += condIt.key() + QLatin1Char( '=' ) + condIt.value() + QLatin1Char( '\x1f' );
+	return result;
+}
+
+QString Template::conditionsSignature( const QList<QMap<QString,QString> > &conditionsList )
+{
+	QString result;
+	for( QList<QMap<QString,QString> >::ConstIterator condIt = conditionsList.begin(); condIt != conditionsList.end(); ++condIt )
+		result += conditionsSignature( *condIt ) + QLatin1Char( '\x1e' );
+	return result;
+}
+
+void Template::QueryCache::clear()
+{
+	mFiles.clear();
+	mIncludePaths.clear();
+	mLibraryPaths.clear();
+	mFrameworkPaths.clear();
+	mStaticLibraries.clear();
+	mDynamicLibraries.clear();
+	mBuildSettings.clear();
+	mPreprocessorDefines.clear();
+	mOutputExtensions.clear();
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// Serialization; see TemplateCache. Fields are written and read in declaration order
+Template::Item::Item( TemplateStreamReader &in )
+	: mConditionSetId( -1 )
+{
+	mConditions = in.readConditions();
+	mInputAbsolutePath = in.readString();
+	mInputRelativePath = in.readString();
+	mOutputAbsolutePath = in.readString();
+	mOutputIsAbsolute = in.readBool();
+	mOutputIsSdkRelative = in.readBool();
+	mOutputIsCinderRelative = in.readBool();
+	mBuildExclude = in.readBool();
+}
+
+void Template::Item::write( TemplateStreamWriter &out ) const
+{
+	out.writeConditions( mConditions );
+	out.writeString( mInputAbsolutePath );
+	out.writeString( mInputRelativePath );
+	out.writeString( mOutputAbsolutePath.toString() );
+	out.writeBool( mOutputIsAbsolute );
+	out.writeBool( mOutputIsSdkRelative );
+	out.writeBool( mOutputIsCinderRelative );
+	out.writeBool( mBuildExclude );
+}
+
+Template::File::File( TemplateStreamReader &in )
+	: Item( in )
+{
+	mType = (Type)in.readInt();
+	mVirtualPath = in.readString();
+	mCompileAs = StringPool::intern( in.readString() );
+	mReplaceContents = in.readBool();
+	mReplaceName = in.readBool();
+	mResourceHeader = in.readBool();
+	mPch = in.readBool();
+	if( in.readBool() ) {
+		mExtra = new Extra;
+		mExtra->mResourceName = in.readString();
+		mExtra->mResourceType = StringPool::intern( in.readString() );
+		mExtra->mResourceId = in.readInt();
+		mExtra->mBuildCopyDestination = StringPool::intern( in.readString() );
+	}
+}
+
+void Template::File::write( TemplateStreamWriter &out ) const
+{
+	Item::write( out );
+	out.writeInt( mType );
+	out.writeString( mVirtualPath.toString() );
+	out.writeString( mCompileAs );
+	out.writeBool( mReplaceContents );
+	out.writeBool( mReplaceName );
+	out.writeBool( mResourceHeader );
+	out.writeBool( mPch );
+	out.writeBool( mExtra.constData() != NULL );
+	if( mExtra ) {
+		out.writeString( mExtra->mResourceName );
+		out.writeString( mExtra->mResourceType );
+		out.writeInt( mExtra->mResourceId );
+		out.writeString( mExtra->mBuildCopyDestination );
+	}
+}
+
+Template::IncludePath::IncludePath( TemplateStreamReader &in )
+	: Item( in )
+{
+	mSystem = in.readBool();
+}
+
+void Template::IncludePath::write( TemplateStreamWriter &out ) const
+{
+	Item::write( out );
+	out.writeBool( mSystem );
+}
+
+Template::BuildSetting::BuildSetting( TemplateStreamReader &in )
+	: Item( in )
+{
+	mKey = in.readString();
+	mValue = in.readString();
+}
+
+void Template::BuildSetting::write( TemplateStreamWriter &out ) const
+{
+	Item::write( out );
+	out.writeString( mKey );
+	out.writeString( mValue );
 }
 
-QList<Template::IncludePath> Template::getIncludePathsMatchingConditions( const QMap<QString,QString> &conditions ) const
+Template::PreprocessorDefine::PreprocessorDefine( TemplateStreamReader &in )
+	: Item( in )
 {
-	return getItemsMatchingConditions<IncludePath>( mIncludePaths, conditions );
+	mValue = in.readString();
 }
 
-QList<Template::LibraryPath> Template::getLibraryPathsMatchingConditions( const QMap<QString,QString> &conditions ) const
+void Template::PreprocessorDefine::write( TemplateStreamWriter &out ) const
 {
-	return getItemsMatchingConditions<LibraryPath>( mLibraryPaths, conditions );
+	Item::write( out );
+	out.writeString( mValue );
 }
 
-QList<Template::FrameworkPath> Template::getFrameworkPathsMatchingConditions( const QMap<QString,QString> &conditions ) const
+Template::OutputExtension::OutputExtension( TemplateStreamReader &in )
+	: Item( in )
 {
-	return getItemsMatchingConditions<FrameworkPath>( mFrameworkPaths, conditions );
+	mValue = in.readString();
 }
 
-QList<Template::StaticLibrary> Template::getStaticLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const
+void Template::OutputExtension::write( TemplateStreamWriter &out ) const
 {
-	return getItemsMatchingConditions<StaticLibrary>( mStaticLibraries, conditions );
+	Item::write( out );
+	out.writeString( mValue );
 }
 
-QList<Template::DynamicLibrary> Template::getDynamicLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const
+template<typename T>
+void Template::writeItems( TemplateStreamWriter &out, const QList<T> &list )
 {
-	return getItemsMatchingConditions<DynamicLibrary>( mDynamicLibraries, conditions );
+	out.writeInt( list.size() );
+	for( typename QList<T>::ConstIterator itemIt = list.constBegin(); itemIt != list.constEnd(); ++itemIt )
+		itemIt->write( out );
 }
 
-QList<Template::BuildSetting> Template::getBuildSettingsMatchingConditions( const QMap<QString,QString> &conditions ) const
+template<typename T>
+void Template::readItems( TemplateStreamReader &in, QList<T> *list )
 {
-	return getItemsMatchingConditions<BuildSetting>( mBuildSettings, conditions );
+	qint32 count = in.readInt();
+	if( ! in.readCount( count ) )
+		return;
+	list->reserve( count );
+	for( qint32 i = 0; i < count && in.ok(); ++i )
+		list->push_back( T( in ) );
 }
 
-QList<Template::PreprocessorDefine> Template::getPreprocessorDefinesMatchingConditions( const QMap<QString,QString> &conditions ) const
+Template::Template( TemplateStreamReader &in )
 {
-	return getItemsMatchingConditions<PreprocessorDefine>( mPreprocessorDefines, conditions );
+	mParentPath = in.readString();
+	mOutputPath = in.readString();
+	mReplacementPrefix = in.readString();
+	mCinderPath = in.readString();
+	mName = in.readString();
+	mId = in.readString();
+	readItems( in, &mFiles );
+	readItems( in, &mIncludePaths );
+	readItems( in, &mLibraryPaths );
+	readItems( in, &mFrameworkPaths );
+	readItems( in, &mStaticLibraries );
+	readItems( in, &mDynamicLibraries );
+	readItems( in, &mBuildSettings );
+	readItems( in, &mPreprocessorDefines );
+	readItems( in, &mOutputExtensions );
+	mCore = in.readBool();
+	qint32 numRequires = in.readInt();
+	for( qint32 i = 0; i < numRequires && in.ok(); ++i )
+		mRequires.push_back( in.readString() );
+	qint32 numSupports = in.readInt();
+	for( qint32 i = 0; i < numSupports && in.ok(); ++i )
+		mSupports.push_back( in.readConditions() );
+
+	indexConditionSets();
 }
 
-QList<Template::OutputExtension> Template::getOutputExtensionsMatchingConditions( const QMap<QString,QString> &conditions ) const
+void Template::write( TemplateStreamWriter &out ) const
 {
-	return getItemsMatchingConditions<OutputExtension>( mOutputExtensions, conditions );
+	out.writeString( mParentPath );
+	out.writeString( mOutputPath );
+	out.writeString( mReplacementPrefix );
+	out.writeString( mCinderPath );
+	out.writeString( mName );
+	out.writeString( mId );
+	writeItems( out, mFiles );
+	writeItems( out, mIncludePaths );
+	writeItems( out, mLibraryPaths );
+	writeItems( out, mFrameworkPaths );
+	writeItems( out, mStaticLibraries );
+	writeItems( out, mDynamicLibraries );
+	writeItems( out, mBuildSettings );
+	writeItems( out, mPreprocessorDefines );
+	writeItems( out, mOutputExtensions );
+	out.writeBool( mCore );
+	out.writeInt( mRequires.size() );
+	for( QList<QString>::ConstIterator reqIt = mRequires.constBegin(); reqIt != mRequires.constEnd(); ++reqIt )
+		out.writeString( *reqIt );
+	out.writeInt( mSupports.size() );
+	for( QList<QMap<QString,QString> >::ConstIterator supIt = mSupports.constBegin(); supIt != mSupports.constEnd(); ++supIt )
+		out.writeConditions( *supIt );
 }
@@ -25,26 +25,85 @@
 
 #include <QMap>
 #include <QList>
+#include <QVector>
 #include <QDir>
 
 #include "TinderBox.h"
+#include "CopyPlan.h"
 #include "ErrorList.h"
+#include "DirListingCache.h"
+#include "TemplateStream.h"
+#include "StringPool.h"
+
+#include <QSharedData>
 
 class Template {
   public:
     class File;
     class IncludePath;
+
+	// Read-only references to items owned by one or more Templates. Valid for as long as the owners are alive and unmodified
+	template<typename T>
+	using ItemRefs = QVector<const T*>;
+
+	// Compares the referenced items by value
+	template<typename T>
+	static bool		itemRefsEqual( const ItemRefs<T> &a, const ItemRefs<T> &b );
+
+	// The attributes of a single element, decoded in one pass. Values point into the DOM, so an instance must not outlive its node
+	class Attributes {
+	  public:
+		typedef enum { ATTR_ABSOLUTE, ATTR_SDK, ATTR_CINDER, ATTR_BUILD_EXCLUDE, ATTR_SYSTEM, ATTR_REPLACE_CONTENTS, ATTR_REPLACE_NAME,
+			ATTR_COMPILE_AS, ATTR_IS_PCH, ATTR_IS_RESOURCE_HEADER, ATTR_NAME, ATTR_TYPE, ATTR_ID, ATTR_COPY, ATTR_DESTINATION,
+			ATTR_COMPILER, ATTR_OS, ATTR_CONFIG, ATTR_CORE, NUM_ATTRIBUTES } Id;
+
+		static const quint32 ALL = 0xFFFFFFFFu;
+		static quint32	bit( Id id ) { return 1u << id; }
+
+		// warns through 'errors' about any attribute not in the 'known' mask; pass NULL to skip warnings
+		Attributes( const pugi::xml_node &node, quint32 known, const QString &tag, ErrorList *errors );
+
+		bool		has( Id id ) const { return ( mPresent & bit( id ) ) != 0; }
+		// case-insensitive test against "true"; false when absent
+		bool		isTrue( Id id ) const;
+		QString		value( Id id ) const { return has( id ) ? QString::fromUtf8( mValues[id] ) : QString(); }
+
+	  private:
+		static int	lookup( const char *name );
+
+		quint32		mPresent;
+		const char*	mValues[NUM_ATTRIBUTES];
+	};
     
+	// A path stored as its directory, interned and so shared by every item in that directory, and its leaf name
+	class Path {
+	  public:
+		Path() {}
+		Path( const QString &path );
+
+		QString		toString() const { return mDir + mLeaf; }
+		bool		isEmpty() const { return mDir.isEmpty() && mLeaf.isEmpty(); }
+
+		bool		operator==( const Path &rhs ) const { return mLeaf == rhs.mLeaf && mDir == rhs.mDir; }
+
+	  private:
+		QString		mDir; // up to and including the last '/'
+		QString		mLeaf;
+	};
+
     class Item {
       public:
 		virtual ~Item() {}
 
-		Item( const QString &parentPath, const QString &inputPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions );
+		Item( const QString &parentPath, const QString &inputPath, const Attributes &attributes, const QMap<QString,QString> &conditions );
+		explicit Item( TemplateStreamReader &in );
+
+		void		write( TemplateStreamWriter &out ) const;
 
 		bool		conditionsMatch( const QMap<QString,QString> &conditions ) const;
 		
-		QString			getAbsoluteInputPath() const { return mInputAbsolutePath; }
-		QString			getRelativeInputPath() const { return mInputRelativePath; }
+		const QString&	getAbsoluteInputPath() const { return mInputAbsolutePath; }
+		const QString&	getRelativeInputPath() const { return mInputRelativePath; }
 		QString			getAbsoluteOutputPath() const;
 		QString			getMacOutputPathRelativeTo( const QString &relativeTo, const QString &cinderPath ) const {
 			return getOutputPathRelativeTo( relativeTo, cinderPath ); }
@@ -67,15 +126,17 @@ class Template {
 			mOutputIsAbsolute == rhs.mOutputIsAbsolute && mOutputIsSdkRelative == rhs.mOutputIsSdkRelative
 			&& mOutputIsCinderRelative == rhs.mOutputIsCinderRelative && mBuildExclude == rhs.mBuildExclude; }
 
-		static QStringList	knownAttributes();
+		static quint32	knownAttributes();
 
 	  protected:
 		QString			getOutputPathRelativeTo( const QString &relativeTo, const QString &cinderPath ) const;
 
-		QMap<QString,QString>		mConditions;
+		QMap<QString,QString>		mConditions; // shares its data with the owning Template's mConditionSets once indexed
+		int							mConditionSetId; // index into the owning Template's mConditionSets; -1 if unindexed
+		// kept joined, as copies, queries and generators ask for them per file
 		QString						mInputAbsolutePath;
 		QString						mInputRelativePath;
-		QString						mOutputAbsolutePath;
+		Path						mOutputAbsolutePath;
 		bool						mOutputIsAbsolute, mOutputIsSdkRelative, mOutputIsCinderRelative;
 		bool						mBuildExclude;
 		
@@ -86,12 +147,17 @@ class Template {
 	  public:
 		typedef enum { SOURCE, HEADER, RESOURCE, ASSET, FRAMEWORK, DIRECTORY, BUILD_COPY, FILE } Type;
 	  
-		File( const QString &parentPath, const QString &inputPath, const pugi::xml_node &dom, Type type, const QMap<QString,QString> &conditions, ErrorList *errors );
+		File( const QString &parentPath, const QString &inputPath, const Attributes &attributes, Type type, const QMap<QString,QString> &conditions, ErrorList *errors );
+		explicit File( TemplateStreamReader &in );
+
+		void			write( TemplateStreamWriter &out ) const;
+
+		static quint32	knownAttributes();
 
       public:
 		File::Type		getType() const { return mType; }
 		
-        QString         getVirtualPath() const { return mVirtualPath; }
+        QString         getVirtualPath() const { return mVirtualPath.toString(); }
         void			setVirtualPath( const QString &virtualPath ) { mVirtualPath = virtualPath; }
 		bool			getReplaceName() const { return mReplaceName; }
 		bool			getReplaceContents() const { return mReplaceContents; }
@@ -103,35 +169,46 @@ class Template {
 		bool			isPch() const { return mPch; }
 
 		// resource-specific
-		QString			getResourceName() const { return mResourceName; }
-		QString			getResourceType() const { return mResourceType; }
-		int				getResourceId() const { return mResourceId; }
-		void			setResourceId( int id ) { mResourceId = id; }
+		QString			getResourceName() const { return mExtra ? mExtra->mResourceName : QString(); }
+		QString			getResourceType() const { return mExtra ? mExtra->mResourceType : QString(); }
+		int				getResourceId() const { return mExtra ? mExtra->mResourceId : -1; }
+		void			setResourceId( int id );
 
 		// build-copy-specific
-		QString			getBuildCopyDestination() const { return mBuildCopyDestination; }
+		QString			getBuildCopyDestination() const { return mExtra ? mExtra->mBuildCopyDestination : QString(); }
 
 		virtual void	setOutputPath( const QString &outputPath, const QString &replaceName, const QString &cinderPath );
 		QString			getMacOutputPath( const QString &outputPath, const QString &replacePrefix, const QString &cinderPath ) const;
 
 	  protected:
+		// fields that only resources and build copies use, allocated only for files that set them
+		struct Extra : public QSharedData {
+			Extra() : mResourceId( -1 ) {}
+
+			QString			mResourceName;
+			QString			mResourceType;
+			int				mResourceId;
+			QString			mBuildCopyDestination;
+		};
+
 		Type			mType;	  
-		QString			mVirtualPath, mCompileAs;
+		Path			mVirtualPath;
+		QString			mCompileAs; // interned
 		bool			mReplaceContents, mReplaceName;
 		// header-specific
 		bool			mResourceHeader; // whether this file is to be used as Resources.h
 		bool			mPch; // whether this file is used as a precompiled header
-		// resource-specific
-		QString			mResourceName;
-		QString			mResourceType;
-		int				mResourceId;
-		// build-copy-specific
-		QString			mBuildCopyDestination;
+		QSharedDataPointer<Extra>	mExtra;
 	};
 
 	class IncludePath : public Item {
 	  public:
-		IncludePath( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors );
+		IncludePath( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions );
+		explicit IncludePath( TemplateStreamReader &in );
+
+		void	write( TemplateStreamWriter &out ) const;
+
+		static quint32	knownAttributes() { return Item::knownAttributes() | Attributes::bit( Attributes::ATTR_SYSTEM ); }
 		
 		bool	isSystem() const { return mSystem; }
 		
@@ -142,27 +219,36 @@ class Template {
 
 	class LibraryPath : public Item {
 	  public:
-		LibraryPath( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors );
+		LibraryPath( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions );
+		explicit LibraryPath( TemplateStreamReader &in ) : Item( in ) {}
 	};
 
 	class FrameworkPath : public Item {
 	  public:
-		FrameworkPath( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors );
+		FrameworkPath( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions );
+		explicit FrameworkPath( TemplateStreamReader &in ) : Item( in ) {}
 	};
 	
 	class StaticLibrary : public Item {
 	  public:
-		StaticLibrary( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors );		
+		StaticLibrary( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions );		
+		explicit StaticLibrary( TemplateStreamReader &in ) : Item( in ) {}
 	};
 
 	class DynamicLibrary : public Item {
 	  public:
-		DynamicLibrary( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors );
+		DynamicLibrary( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions );
+		explicit DynamicLibrary( TemplateStreamReader &in ) : Item( in ) {}
 	};
 
 	class BuildSetting : public Item {
 	  public:
-		BuildSetting( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors );
+		BuildSetting( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions );
+		explicit BuildSetting( TemplateStreamReader &in );
+
+		void		write( TemplateStreamWriter &out ) const;
+
+		static quint32	knownAttributes() { return Attributes::bit( Attributes::ATTR_NAME ); }
 		
 		QString		getKey() const { return mKey; }
 		QString		getValue() const { return mValue; }
@@ -172,7 +258,10 @@ class Template {
 
 	class PreprocessorDefine : public Item {
 	  public:
-		PreprocessorDefine( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors );
+		PreprocessorDefine( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions );
+		explicit PreprocessorDefine( TemplateStreamReader &in );
+
+		void		write( TemplateStreamWriter &out ) const;
 
 		QString		getValue() const { return mValue; }
 
@@ -181,7 +270,10 @@ class Template {
 
 	class OutputExtension : public Item {
 	  public:
-		OutputExtension( const QString &parentPath, const pugi::xml_node &dom, const QMap<QString,QString> &conditions, ErrorList *errors );
+		OutputExtension( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, const QMap<QString,QString> &conditions );
+		explicit OutputExtension( TemplateStreamReader &in );
+
+		void		write( TemplateStreamWriter &out ) const;
 
 		QString		getValue() const { return mValue; }
 
@@ -190,6 +282,8 @@ class Template {
 
 	Template() {}
 	Template( const QString &parentPath, const pugi::xml_node &doc, ErrorList *errors );
+	// restores a Template saved with write(); check in.ok() before using the result
+	explicit Template( TemplateStreamReader &in );
 	virtual ~Template() {}
 
 	QString		getName() const { return mName; }
@@ -207,31 +301,98 @@ class Template {
 	void			setupVirtualPaths( const QString &virtualPath );
 
 	bool			supportsConditions( const QMap<QString,QString> &conditions ) const;
+	static bool		conditionsMatch( const QMap<QString,QString> &itemConditions, const QMap<QString,QString> &conditions );
+	// a string equal for and only for equal conditions; suitable as a memoization key
+	static QString	conditionsSignature( const QMap<QString,QString> &conditions );
+	static QString	conditionsSignature( const QList<QMap<QString,QString> > &conditionsList );
 	bool			isCore() const { return mCore; }
 
-	void			instantiateFilesMatchingConditions( const QList<QMap<QString,QString> > &conditionsList, bool overwriteExisting ) const;
-	QList<File>		getFilesMatchingConditions( const QList<QMap<QString,QString> > &conditionsList ) const;
-	QList<File>		getFilesMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	// adds the copies of every item matching any of 'conditionsList' to 'plan'; 'mode' and 'compareContents' apply to files whose contents aren't replaced
+	void			instantiateFilesMatchingConditions( const QList<QMap<QString,QString> > &conditionsList, bool overwriteExisting, CopyPlan *plan,
+														CopyMode mode = COPY_MODE_COPY, bool compareContents = false ) const;
 
-	QList<IncludePath>		getIncludePathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<LibraryPath>		getLibraryPathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<FrameworkPath>	getFrameworkPathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<StaticLibrary>	getStaticLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<DynamicLibrary>	getDynamicLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<BuildSetting>		getBuildSettingsMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<PreprocessorDefine>	getPreprocessorDefinesMatchingConditions( const QMap<QString,QString> &conditions ) const;
-	QList<OutputExtension>	getOutputExtensionsMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	// Query results reference this Template's own items; they are invalidated by setOutputPath() and setupVirtualPaths()
+	ItemRefs<File>				getFilesMatchingConditions( const QList<QMap<QString,QString> > &conditionsList ) const;
+	ItemRefs<File>				getFilesMatchingConditions( const QMap<QString,QString> &conditions ) const;
+
+	ItemRefs<IncludePath>		getIncludePathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	ItemRefs<LibraryPath>		getLibraryPathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	ItemRefs<FrameworkPath>		getFrameworkPathsMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	ItemRefs<StaticLibrary>		getStaticLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	ItemRefs<DynamicLibrary>	getDynamicLibrariesMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	ItemRefs<BuildSetting>		getBuildSettingsMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	ItemRefs<PreprocessorDefine>	getPreprocessorDefinesMatchingConditions( const QMap<QString,QString> &conditions ) const;
+	ItemRefs<OutputExtension>	getOutputExtensionsMatchingConditions( const QMap<QString,QString> &conditions ) const;
 
 	QString			getOutputPath() const { return mOutputPath; }
 	QString			getParentPath() const { return mParentPath; }
+	// every directory the last parse listed while expanding <sourcePattern> and <headerPattern>; not serialized
+	const QStringList&	getPatternDirs() const { return mPatternDirs; }
+
+	void			write( TemplateStreamWriter &out ) const;
 
   protected:
-	void		processFilePattern( const QString &parentPath, const pugi::xml_node &dom, File::Type type, const QMap<QString,QString> &conditions, ErrorList *errors );
+	// Memoized query results, keyed on the signature of the query's conditions. Results are implicitly shared vectors of
+	// pointers into our own item lists, so it is never copied along with its Template and is cleared whenever items change.
+	class QueryCache {
+	  public:
+		QueryCache() {}
+		QueryCache( const QueryCache & ) {}
+		QueryCache&		operator=( const QueryCache & ) { clear(); return *this; }
+
+		void	clear();
+
+		QMap<QString,ItemRefs<File> >				mFiles;
+		QMap<QString,ItemRefs<IncludePath> >		mIncludePaths;
+		QMap<QString,ItemRefs<LibraryPath> >		mLibraryPaths;
+		QMap<QString,ItemRefs<FrameworkPath> >		mFrameworkPaths;
+		QMap<QString,ItemRefs<StaticLibrary> >		mStaticLibraries;
+		QMap<QString,ItemRefs<DynamicLibrary> >		mDynamicLibraries;
+		QMap<QString,ItemRefs<BuildSetting> >		mBuildSettings;
+		QMap<QString,ItemRefs<PreprocessorDefine> >	mPreprocessorDefines;
+		QMap<QString,ItemRefs<OutputExtension> >	mOutputExtensions;
+	};
+
+	// A <sourcePattern> or <headerPattern> awaiting expansion. Patterns are expanded together once parsing is complete,
+	// in parallel, and their matches spliced into mFiles at the position the pattern was declared.
+	struct PendingPattern {
+		PendingPattern( int index, const QString &parentPath, const File &prototype )
+			: mIndex( index ), mParentPath( parentPath ), mPrototype( prototype ), mCache( NULL )
+		{}
+
+		int					mIndex;
+		QString				mParentPath;
+		File				mPrototype;
+		DirListingCache		*mCache;
+		QStringList			mMatches;
+		QStringList			mListedDirs;
+	};
+
+	void		processFilePattern( const QString &parentPath, const pugi::xml_node &dom, const Attributes &attributes, File::Type type, const QMap<QString,QString> &conditions, ErrorList *errors );
+	void		expandFilePatterns();
+	static void	expandFilePattern( PendingPattern &pattern );
+	template<typename T>
+	ItemRefs<T>	getItemsMatchingConditions( const QList<T> &list, QMap<QString,ItemRefs<T> > &cache, const QList<QMap<QString,QString> > &conditionsList ) const;
+	template<typename T>
+	static void	writeItems( TemplateStreamWriter &out, const QList<T> &list );
 	template<typename T>
-	QList<T>	getItemsMatchingConditions( const QList<T> &list, const QMap<QString,QString> &conditions ) const;
+	static void	readItems( TemplateStreamReader &in, QList<T> *list );
 	void		parseGroup( const pugi::xml_node &node, QMap<QString,QString> conditions, ErrorList *errors );
 	void		parseSupports( const pugi::xml_node &node, ErrorList *errors );
 
+	// Two-phase parsing for subclasses that defer their contents: parseHeader() reads only the id, name, core flag,
+	// <requires> and <supports>; parseBody() then parses everything else, replacing what parseHeader() read
+	void		parseHeader( const pugi::xml_node &doc );
+	void		parseHeaderGroup( const pugi::xml_node &node );
+	void		parseBody( const pugi::xml_node &doc, ErrorList *errors );
+
+	// assigns every item the ID of its distinct condition set; run once parsing is complete
+	void			indexConditionSets();
+	template<typename T>
+	void			indexConditionSets( QList<T> &list );
+	int				registerConditionSet( const QMap<QString,QString> &conditions );
+	QVector<bool>	matchConditionSets( const QList<QMap<QString,QString> > &conditionsList ) const;
+
 	QString					mParentPath;
 	QString					mOutputPath, mReplacementPrefix, mCinderPath;
 	
@@ -245,10 +406,28 @@ class Template {
 	QList<BuildSetting>		mBuildSettings;
 	QList<PreprocessorDefine>	mPreprocessorDefines;
 	QList<OutputExtension>		mOutputExtensions;
+	QList<PendingPattern>		mPendingPatterns;
+	QStringList					mPatternDirs;
 
 	bool							mCore;
 	QList<QString>					mRequires;
 	QList<QMap<QString,QString> >	mSupports;
+
+	// each distinct set of conditions items were declared under, and a lookup from signature to index
+	QList<QMap<QString,QString> >	mConditionSets;
+	QMap<QString,int>				mConditionSetIds;
+	mutable QueryCache				mQueryCache;
 };
 
+template<typename T>
+bool Template::itemRefsEqual( const ItemRefs<T> &a, const ItemRefs<T> &b )
+{
+	if( a.size() != b.size() )
+		return false;
+	for( int i = 0; i < a.size(); ++i )
+		if( a[i] != b[i] && ! ( *a[i] == *b[i] ) )
+			return false;
+	return true;
+}
+
 typedef QSharedPointer<Template> TemplateRef;
@@ -0,0 +1,375 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "TemplateCache.h"
+#include "TemplateStream.h"
+#include "Trace.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+namespace {
+
+const quint32 SNAPSHOT_MAGIC = 0x54425843; // "TBXC"
+// bump whenever the layout below, Template or any of its serialized subclasses change
+const quint32 SNAPSHOT_VERSION = 5;
+
+template<typename InputT>
+void writeInput( QDataStream &out, const InputT &input )
+{
+	out << input.mIsDir << input.mPath << input.mSize << input.mModified << input.mHash;
+}
+
+template<typename InputT>
+void readInput( QDataStream &in, InputT *input )
+{
+	in >> input->mIsDir >> input->mPath >> input->mSize >> input->mModified >> input->mHash;
+}
+
+} // anonymous namespace
+
+TemplateCache::TemplateCache( const QString &kind, const QString &rootPath )
+	: mKind( kind ), mRootPath( QDir( rootPath ).absolutePath() ), mDiscoveryReused( false )
+{
+	QByteArray key = QCryptographicHash::hash( mRootPath.toUtf8(), QCryptographicHash::Sha1 ).toHex().left( 16 );
+	mSnapshotPath = QStandardPaths::writableLocation( QStandardPaths::CacheLocation ) + "/" + mKind + "-" + QString::fromLatin1( key ) + ".tbxc";
+}
+
+QString TemplateCache::normalize( const QString &path )
+{
+	return QDir::cleanPath( QFileInfo( path ).absoluteFilePath() );
+}
+
+void TemplateCache::addDir( const QString &path )
+{
+	mDirs.push_back( restat( true, QDir::cleanPath( QDir( path ).absolutePath() ) ) );
+}
+
+void TemplateCache::addDirs( const QStringList &paths )
+{
+	for( QStringList::ConstIterator pathIt = paths.constBegin(); pathIt != paths.constEnd(); ++pathIt )
+		addDir( *pathIt );
+}
+
+void TemplateCache::addManifest( const Manifest &manifest, bool reused )
+{
+	mManifests.push_back( manifest );
+	mManifests.back().mPath = normalize( manifest.mPath );
+	mManifestsReused.push_back( reused );
+}
+
+QStringList TemplateCache::getInputPaths() const
+{
+	QStringList result;
+	for( QList<Input>::ConstIterator dirIt = mDirs.constBegin(); dirIt != mDirs.constEnd(); ++dirIt )
+		result.push_back( dirIt->mPath );
+	for( QList<Manifest>::ConstIterator manifestIt = mManifests.constBegin(); manifestIt != mManifests.constEnd(); ++manifestIt ) {
+		result.push_back( manifestIt->mPath );
+		for( QList<Input>::ConstIterator depIt = manifestIt->mDependencies.constBegin(); depIt != manifestIt->mDependencies.constEnd(); ++depIt )
+			result.push_back( depIt->mPath );
+	}
+	result.removeDuplicates();
+	return result;
+}
+
+TemplateCache::Input TemplateCache::stamp( const QString &path )
+{
+	return stat( false, normalize( path ), true );
+}
+
+void TemplateCache::addDependency( Manifest *manifest, const QString &filePath )
+{
+	manifest->mDependencies.push_back( stat( false, normalize( filePath ), true ) );
+}
+
+void TemplateCache::addPatternDependencies( Manifest *manifest, const Template &tmpl )
+{
+	DirListingCache *listings = DirListingCache::current();
+	const QStringList &dirPaths = tmpl.getPatternDirs();
+	for( QStringList::ConstIterator dirIt = dirPaths.constBegin(); dirIt != dirPaths.constEnd(); ++dirIt ) {
+		// outside of a scan the listings are gone, so stamp the directory as it is now
+		if( listings )
+			manifest->mDependencies.push_back( stampListing( *dirIt, listings->list( *dirIt ) ) );
+		else
+			manifest->mDependencies.push_back( stat( true, QDir::cleanPath( *dirIt ), true ) );
+	}
+}
+
+TemplateCache::Input TemplateCache::stampListing( const QString &dirPath, const DirListingCache::Listing &listing )
+{
+	// the same size and hash stat() would produce, but of the entries the parse actually saw
+	Input input;
+	input.mIsDir = true;
+	input.mPath = QDir::cleanPath( QDir( dirPath ).absolutePath() );
+	if( listing.mExists ) {
+		input.mSize = listing.mFiles.size() + listing.mDirs.size();
+		input.mModified = listing.mModified;
+		QCryptographicHash listingHash( QCryptographicHash::Sha1 );
+		listingHash.addData( listing.mFiles.join( '\n' ).toUtf8() );
+		listingHash.addData( "\n/\n" );
+		listingHash.addData( listing.mDirs.join( '\n' ).toUtf8() );
+		input.mHash = listingHash.result();
+	}
+	return input;
+}
+
+QByteArray TemplateCache::hash( bool isDir, const QString &path )
+{
+	QCryptographicHash result( QCryptographicHash::Sha1 );
+	if( isDir ) {
+		QDir dir( path );
+		QStringList files = dir.entryList( QDir::Files | QDir::NoDotAndDotDot );
+		QStringList dirs = dir.entryList( QDir::Dirs | QDir::NoDotAndDotDot );
+		result.addData( files.join( '\n' ).toUtf8() );
+		result.addData( "\n/\n" );
+		result.addData( dirs.join( '\n' ).toUtf8() );
+	}
+	else {
+		QFile file( path );
+		if( file.open( QIODevice::ReadOnly ) )
+			result.addData( &file );
+	}
+	return result.result();
+}
+
+TemplateCache::Input TemplateCache::stat( bool isDir, const QString &path, bool withHash )
+{
+	Input input;
+	input.mIsDir = isDir;
+	input.mPath = path;
+	input.mSize = -1;
+	input.mModified = 0;
+
+	QFileInfo info( path );
+	if( isDir ? info.isDir() : info.isFile() ) {
+		input.mSize = isDir ? QDir( path ).entryList( QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot ).size() : info.size();
+		input.mModified = info.lastModified().toMSecsSinceEpoch();
+		if( withHash )
+			input.mHash = hash( isDir, path );
+	}
+	return input;
+}
+
+TemplateCache::Input TemplateCache::restat( bool isDir, const QString &path ) const
+{
+	Input result = stat( isDir, path, false );
+	QMap<QString,Input>::ConstIterator previousIt = mPreviousInputs.constFind( path );
+	if( previousIt != mPreviousInputs.constEnd() && previousIt->mIsDir == isDir && previousIt->mSize == result.mSize && previousIt->mModified == result.mModified )
+		result.mHash = previousIt->mHash;
+	else if( result.mSize >= 0 )
+		result.mHash = hash( isDir, path );
+	return result;
+}
+
+bool TemplateCache::isCurrent( const Input &input )
+{
+	// adding, removing or renaming an entry updates a directory's mtime, so an unchanged one needn't be listed
+	QFileInfo info( input.mPath );
+	const bool exists = input.mIsDir ? info.isDir() : info.isFile();
+	if( ! exists )
+		return input.mSize < 0;
+	if( input.mSize >= 0 && info.lastModified().toMSecsSinceEpoch() == input.mModified && ( input.mIsDir || info.size() == input.mSize ) )
+		return true;
+
+	Input now = stat( input.mIsDir, input.mPath, false );
+	if( now.mSize != input.mSize )
+		return false;
+	// touched but possibly unchanged, ie after a checkout
+	return hash( input.mIsDir, input.mPath ) == input.mHash;
+}
+
+bool TemplateCache::load()
+{
+	TBOX_TRACE_SCOPE( "TemplateCache::load" );
+	QFile file( mSnapshotPath );
+	if( ! file.open( QIODevice::ReadOnly ) )
+		return false;
+	uchar *data = file.map( 0, file.size() );
+	if( ! data )
+		return false;
+
+	// decoding copies everything it needs out of the mapping
+	QDataStream in( QByteArray::fromRawData( reinterpret_cast<const char*>( data ), file.size() ) );
+	in.setVersion( QDataStream::Qt_5_0 );
+
+	quint32 magic = 0, version = 0;
+	QString rootPath;
+	in >> magic >> version >> rootPath;
+	if( magic != SNAPSHOT_MAGIC || version != SNAPSHOT_VERSION || rootPath != mRootPath || in.status() != QDataStream::Ok )
+		return false;
+
+	QList<Input> dirs;
+	quint32 numDirs = 0;
+	in >> numDirs;
+	for( quint32 d = 0; d < numDirs && in.status() == QDataStream::Ok; ++d ) {
+		Input input;
+		readInput( in, &input );
+		dirs.push_back( input );
+	}
+
+	QStringList discoveredPaths;
+	in >> discoveredPaths;
+
+	QList<Manifest> manifests;
+	quint32 numManifests = 0;
+	in >> numManifests;
+	for( quint32 e = 0; e < numManifests && in.status() == QDataStream::Ok; ++e ) {
+		Manifest manifest;
+		readInput( in, &manifest.mStamp );
+		manifest.mPath = manifest.mStamp.mPath;
+		quint32 numDependencies = 0;
+		in >> numDependencies;
+		for( quint32 d = 0; d < numDependencies && in.status() == QDataStream::Ok; ++d ) {
+			Input input;
+			readInput( in, &input );
+			manifest.mDependencies.push_back( input );
+		}
+		in >> manifest.mParsed >> manifest.mTemplatePaths >> manifest.mIconPath;
+		quint32 numMessages = 0;
+		in >> numMessages;
+		for( quint32 m = 0; m < numMessages && in.status() == QDataStream::Ok; ++m ) {
+			bool isError;
+			QString msg, filePath;
+			in >> isError >> msg >> filePath;
+			manifest.mMessages.push_back( ErrorList::Error( isError, msg, filePath ) );
+		}
+		manifests.push_back( manifest );
+	}
+	if( in.status() != QDataStream::Ok )
+		return false;
+
+	TemplateStreamReader reader( in );
+	for( QList<Manifest>::Iterator manifestIt = manifests.begin(); manifestIt != manifests.end() && reader.ok(); ++manifestIt ) {
+		qint32 numBlocks = reader.readInt();
+		for( qint32 b = 0; b < numBlocks && reader.ok(); ++b )
+			manifestIt->mCinderBlocks.push_back( CinderBlock( reader ) );
+		qint32 numTemplates = reader.readInt();
+		for( qint32 t = 0; t < numTemplates && reader.ok(); ++t )
+			manifestIt->mProjectTemplates.push_back( ProjectTemplate( reader ) );
+	}
+	if( ! reader.ok() )
+		return false;
+
+	mPreviousDirs = dirs;
+	mPreviousDiscoveredPaths = discoveredPaths;
+	for( QList<Input>::ConstIterator dirIt = dirs.constBegin(); dirIt != dirs.constEnd(); ++dirIt )
+		mPreviousInputs.insert( dirIt->mPath, *dirIt );
+	for( QList<Manifest>::ConstIterator manifestIt = manifests.constBegin(); manifestIt != manifests.constEnd(); ++manifestIt ) {
+		mPreviousManifests.insert( manifestIt->mPath, *manifestIt );
+		mPreviousInputs.insert( manifestIt->mPath, manifestIt->mStamp );
+		for( QList<Input>::ConstIterator depIt = manifestIt->mDependencies.constBegin(); depIt != manifestIt->mDependencies.constEnd(); ++depIt )
+			mPreviousInputs.insert( depIt->mPath, *depIt );
+	}
+	return true;
+}
+
+bool TemplateCache::reuseDiscovery()
+{
+	if( mPreviousDirs.isEmpty() )
+		return false;
+	for( QList<Input>::ConstIterator dirIt = mPreviousDirs.constBegin(); dirIt != mPreviousDirs.constEnd(); ++dirIt ) {
+		if( ! isCurrent( *dirIt ) )
+			return false;
+	}
+
+	mDirs = mPreviousDirs;
+	mDiscoveredPaths = mPreviousDiscoveredPaths;
+	mDiscoveryReused = true;
+	return true;
+}
+
+bool TemplateCache::findCurrent( const QString &path, Manifest *result ) const
+{
+	QMap<QString,Manifest>::ConstIterator manifestIt = mPreviousManifests.constFind( normalize( path ) );
+	if( manifestIt == mPreviousManifests.constEnd() || ! isCurrent( manifestIt->mStamp ) )
+		return false;
+	for( QList<Input>::ConstIterator depIt = manifestIt->mDependencies.constBegin(); depIt != manifestIt->mDependencies.constEnd(); ++depIt ) {
+		if( ! isCurrent( *depIt ) )
+			return false;
+	}
+
+	*result = manifestIt.value();
+	return true;
+}
+
+void TemplateCache::save() const
+{
+	// nothing was rediscovered or reparsed, so the saved index still describes the tree
+	if( mDiscoveryReused && ! mManifestsReused.contains( false ) && mManifests.size() == mPreviousManifests.size() )
+		return;
+
+	TBOX_TRACE_SCOPE( "TemplateCache::save" );
+	if( ! QDir().mkpath( QFileInfo( mSnapshotPath ).absolutePath() ) )
+		return;
+
+	QSaveFile file( mSnapshotPath );
+	if( ! file.open( QIODevice::WriteOnly ) )
+		return;
+
+	QDataStream out( &file );
+	out.setVersion( QDataStream::Qt_5_0 );
+	out << SNAPSHOT_MAGIC << SNAPSHOT_VERSION << mRootPath;
+
+	out << (quint32)mDirs.size();
+	for( QList<Input>::ConstIterator dirIt = mDirs.constBegin(); dirIt != mDirs.constEnd(); ++dirIt )
+		writeInput( out, *dirIt );
+
+	out << mDiscoveredPaths;
+
+	out << (quint32)mManifests.size();
+	for( QList<Manifest>::ConstIterator manifestIt = mManifests.constBegin(); manifestIt != mManifests.constEnd(); ++manifestIt ) {
+		const Manifest &manifest = *manifestIt;
+		// stamped as they were read, never after, so a change made mid-scan can't be recorded as already seen
+		writeInput( out, manifest.mStamp );
+		out << (quint32)manifest.mDependencies.size();
+		for( QList<Input>::ConstIterator depIt = manifest.mDependencies.constBegin(); depIt != manifest.mDependencies.constEnd(); ++depIt )
+			writeInput( out, *depIt );
+
+		out << manifest.mParsed << manifest.mTemplatePaths << manifest.mIconPath;
+		out << (quint32)manifest.mMessages.size();
+		for( QList<ErrorList::Error>::ConstIterator msgIt = manifest.mMessages.constBegin(); msgIt != manifest.mMessages.constEnd(); ++msgIt )
+			out << msgIt->mIsError << msgIt->mMsg << msgIt->mFilePath;
+	}
+
+	TemplateStreamWriter writer;
+	for( QList<Manifest>::ConstIterator manifestIt = mManifests.constBegin(); manifestIt != mManifests.constEnd(); ++manifestIt ) {
+		writer.writeInt( manifestIt->mCinderBlocks.size() );
+		for( QList<CinderBlock>::ConstIterator blockIt = manifestIt->mCinderBlocks.constBegin(); blockIt != manifestIt->mCinderBlocks.constEnd(); ++blockIt )
+			blockIt->write( writer );
+		writer.writeInt( manifestIt->mProjectTemplates.size() );
+		for( QList<ProjectTemplate>::ConstIterator tmplIt = manifestIt->mProjectTemplates.constBegin(); tmplIt != manifestIt->mProjectTemplates.constEnd(); ++tmplIt )
+			tmplIt->write( writer );
+	}
+	writer.writeTo( out );
+
+	if( out.status() == QDataStream::Ok )
+		file.commit();
+	else
+		file.cancelWriting();
+}
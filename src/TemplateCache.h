@@ -0,0 +1,122 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "CinderBlock.h"
+#include "DirListingCache.h"
+#include "ProjectTemplate.h"
+#include "ErrorList.h"
+
+#include <QByteArray>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+// A versioned binary index of one scan of a Cinder tree, stored per scan 'kind' and root path in the user's cache
+// directory. It records the directories the scan walked to discover manifests (cinderblock.xml and template.xml files)
+// and, for each manifest, its parsed results along with the files and directories they were derived from. Inputs are
+// judged unchanged by size and mtime, falling back to a content hash when only the mtime differs; a directory whose
+// mtime is unchanged isn't listed at all. A rescan reuses every manifest whose inputs are unchanged and reparses only
+// the rest. Warnings and errors are stored with their manifest and replayed along with its results.
+class TemplateCache {
+  public:
+	// a file or directory as it was when stamped; stamps are taken before the input is read, so a change made while a
+	// scan reads it leaves the stamp out of date and the next scan reparses
+	struct Input {
+		Input() : mIsDir( false ), mSize( -1 ), mModified( 0 ) {}
+
+		bool		mIsDir;
+		QString		mPath;
+		qint64		mSize; // entry count for directories; -1 if missing
+		qint64		mModified;
+		QByteArray	mHash;
+	};
+
+	// the results of parsing one manifest
+	struct Manifest {
+		Manifest() : mParsed( false ) {}
+
+		QString					mPath;
+		Input					mStamp; // the manifest itself; see stamp()
+		bool					mParsed; // false if the XML itself couldn't be parsed
+		QList<CinderBlock>		mCinderBlocks;
+		QList<ProjectTemplate>	mProjectTemplates;
+		QStringList				mTemplatePaths; // the templates a cinderblock.xml refers to
+		QString					mIconPath;
+		QList<ErrorList::Error>	mMessages;
+		// besides the manifest itself; see addDependency()
+		QList<Input>			mDependencies;
+	};
+
+	TemplateCache( const QString &kind, const QString &rootPath );
+
+	// Reads the index saved by the previous scan; false if there is none or it can't be used
+	bool	load();
+	// If every directory the previous scan walked is unchanged, adopts its list of discovered manifests and returns true
+	bool	reuseDiscovery();
+	// the previous scan's results for the manifest at 'path', if it and everything it depends on are unchanged
+	bool	findCurrent( const QString &path, Manifest *result ) const;
+
+	// inputs and results of this scan, in the order they were discovered
+	void	addDir( const QString &path );
+	void	addDirs( const QStringList &paths );
+	void	setDiscoveredPaths( const QStringList &paths ) { mDiscoveredPaths = paths; }
+	const QStringList&	getDiscoveredPaths() const { return mDiscoveredPaths; }
+	// 'reused' marks a manifest returned by findCurrent(); the index is only rewritten if something was reparsed
+	void	addManifest( const Manifest &manifest, bool reused );
+	void	save() const;
+	// every directory and file this scan's results were derived from, for watching; call after the last addManifest()
+	QStringList	getInputPaths() const;
+
+	// Stamps a manifest file; call before reading it. Safe to call from any thread.
+	static Input	stamp( const QString &path );
+	// Records a file a manifest's results depend on, stamped now; call before reading it
+	static void		addDependency( Manifest *manifest, const QString &filePath );
+	// Records every directory 'tmpl' listed while expanding its file patterns, wherever they lie, stamped from the
+	// listings of the current scan that the expansion used
+	static void		addPatternDependencies( Manifest *manifest, const Template &tmpl );
+
+  private:
+	static Input		stampListing( const QString &dirPath, const DirListingCache::Listing &listing );
+	static QString		normalize( const QString &path );
+	static Input		stat( bool isDir, const QString &path, bool withHash );
+	static QByteArray	hash( bool isDir, const QString &path );
+	static bool			isCurrent( const Input &input );
+	// as stat() with a hash, but reuses the previous scan's hash of an input that hasn't changed
+	Input				restat( bool isDir, const QString &path ) const;
+
+	QString				mKind, mRootPath, mSnapshotPath;
+
+	QList<Input>		mDirs; // stamped by addDir(), before the scan lists them
+	bool				mDiscoveryReused;
+	QStringList			mDiscoveredPaths;
+	QList<Manifest>		mManifests;
+	QList<bool>			mManifestsReused;
+
+	QList<Input>		mPreviousDirs;
+	QStringList			mPreviousDiscoveredPaths;
+	QMap<QString,Manifest>	mPreviousManifests;
+	QMap<QString,Input>	mPreviousInputs; // every input of the previous scan, by path
+};
@@ -0,0 +1,167 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "TemplateStream.h"
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// TemplateStreamWriter
+TemplateStreamWriter::TemplateStreamWriter()
+	: mStream( &mBody, QIODevice::WriteOnly )
+{
+	mStream.setVersion( QDataStream::Qt_5_0 );
+}
+
+quint32 TemplateStreamWriter::intern( const QString &str )
+{
+	QHash<QString,quint32>::ConstIterator it = mStringIds.constFind( str );
+	if( it != mStringIds.constEnd() )
+		return it.value();
+
+	quint32 id = mStrings.size();
+	mStrings.push_back( str );
+	mStringIds.insert( str, id );
+	return id;
+}
+
+void TemplateStreamWriter::writeString( const QString &str )
+{
+	mStream << intern( str );
+}
+
+void TemplateStreamWriter::writeConditions( const QMap<QString,QString> &conditions )
+{
+	// key on the interned ids; they are unambiguous where the strings themselves might not be
+	QString key;
+	for( QMap<QString,QString>::ConstIterator condIt = conditions.constBegin(); condIt != conditions.constEnd(); ++condIt )
+		key += QString::number( intern( condIt.key() ) ) + ':' + QString::number( intern( condIt.value() ) ) + ';';
+
+	QMap<QString,quint32>::ConstIterator it = mConditionSetIds.constFind( key );
+	quint32 id;
+	if( it != mConditionSetIds.constEnd() )
+		id = it.value();
+	else {
+		id = mConditionSets.size();
+		mConditionSets.push_back( conditions );
+		mConditionSetIds.insert( key, id );
+	}
+
+	mStream << id;
+}
+
+void TemplateStreamWriter::writeTo( QDataStream &out ) const
+{
+	out << (quint32)mStrings.size();
+	for( QVector<QString>::ConstIterator strIt = mStrings.constBegin(); strIt != mStrings.constEnd(); ++strIt )
+		out << *strIt;
+
+	out << (quint32)mConditionSets.size();
+	for( QVector<QMap<QString,QString> >::ConstIterator setIt = mConditionSets.constBegin(); setIt != mConditionSets.constEnd(); ++setIt ) {
+		out << (quint32)setIt->size();
+		for( QMap<QString,QString>::ConstIterator condIt = setIt->constBegin(); condIt != setIt->constEnd(); ++condIt )
+			out << mStringIds.value( condIt.key() ) << mStringIds.value( condIt.value() );
+	}
+
+	out.writeRawData( mBody.constData(), mBody.size() );
+}
+
+//////////////////////////////////////////////////////////////////////////////////////////////
+// TemplateStreamReader
+TemplateStreamReader::TemplateStreamReader( QDataStream &in )
+	: mStream( in ), mOk( true )
+{
+	quint32 numStrings = 0;
+	mStream >> numStrings;
+	if( ! readCount( numStrings ) )
+		return;
+	mStrings.reserve( numStrings );
+	for( quint32 s = 0; s < numStrings && mStream.status() == QDataStream::Ok; ++s ) {
+		QString str;
+		mStream >> str;
+		mStrings.push_back( str );
+	}
+
+	quint32 numSets = 0;
+	mStream >> numSets;
+	if( ! readCount( numSets ) )
+		return;
+	mConditionSets.reserve( numSets );
+	for( quint32 c = 0; c < numSets && mStream.status() == QDataStream::Ok; ++c ) {
+		quint32 size = 0;
+		mStream >> size;
+		QMap<QString,QString> conditions;
+		for( quint32 i = 0; i < size && mStream.status() == QDataStream::Ok; ++i ) {
+			quint32 key = 0, value = 0;
+			mStream >> key >> value;
+			if( key >= (quint32)mStrings.size() || value >= (quint32)mStrings.size() ) {
+				mOk = false;
+				return;
+			}
+			conditions.insert( mStrings[key], mStrings[value] );
+		}
+		mConditionSets.push_back( conditions );
+	}
+}
+
+QString TemplateStreamReader::readString()
+{
+	quint32 id = 0;
+	mStream >> id;
+	if( id >= (quint32)mStrings.size() ) {
+		mOk = false;
+		return QString();
+	}
+	return mStrings[id];
+}
+
+QMap<QString,QString> TemplateStreamReader::readConditions()
+{
+	quint32 id = 0;
+	mStream >> id;
+	if( id >= (quint32)mConditionSets.size() ) {
+		mOk = false;
+		return QMap<QString,QString>();
+	}
+	return mConditionSets[id];
+}
+
+bool TemplateStreamReader::readBool()
+{
+	quint8 value = 0;
+	mStream >> value;
+	return value != 0;
+}
+
+qint32 TemplateStreamReader::readInt()
+{
+	qint32 value = 0;
+	mStream >> value;
+	return value;
+}
+
+bool TemplateStreamReader::readCount( qint64 count, int minEntrySize )
+{
+	const qint64 available = mStream.device() ? mStream.device()->bytesAvailable() : 0;
+	if( count < 0 || count * minEntrySize > available )
+		mOk = false;
+	return ok();
+}
@@ -0,0 +1,80 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include <QVector>
+
+// Binary encoding of parsed Templates, used by TemplateCache. Strings and condition sets are interned: the body
+// refers to them by index into tables that precede it, so a block's repeated paths and <platform> conditions are
+// stored (and on load, allocated) once.
+class TemplateStreamWriter {
+  public:
+	TemplateStreamWriter();
+
+	void	writeString( const QString &str );
+	void	writeConditions( const QMap<QString,QString> &conditions );
+	void	writeBool( bool value ) { mStream << (quint8)( value ? 1 : 0 ); }
+	void	writeInt( qint32 value ) { mStream << value; }
+
+	// writes the string and condition tables followed by the body
+	void	writeTo( QDataStream &out ) const;
+
+  private:
+	quint32		intern( const QString &str );
+
+	QByteArray							mBody;
+	QDataStream							mStream;
+	QVector<QString>					mStrings;
+	QHash<QString,quint32>				mStringIds;
+	QVector<QMap<QString,QString> >		mConditionSets;
+	QMap<QString,quint32>				mConditionSetIds;
+};
+
+class TemplateStreamReader {
+  public:
+	// reads the tables from 'in', leaving it positioned at the start of the body
+	explicit TemplateStreamReader( QDataStream &in );
+
+	QString					readString();
+	QMap<QString,QString>	readConditions();
+	bool					readBool();
+	qint32					readInt();
+	// Checks a count just read against the bytes left, each of 'count' entries taking at least 'minEntrySize'; a
+	// count a corrupt stream couldn't hold fails the reader rather than being allocated
+	bool					readCount( qint64 count, int minEntrySize = 4 );
+
+	// false once any read has failed or referenced a table entry that does not exist
+	bool	ok() const { return mOk && mStream.status() == QDataStream::Ok; }
+
+  private:
+	QDataStream							&mStream;
+	bool								mOk;
+	QVector<QString>					mStrings;
+	QVector<QMap<QString,QString> >		mConditionSets;
+};
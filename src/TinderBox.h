@@ -27,7 +27,6 @@
 
 #include <QException>
 #include <QDebug>
-#include <QMessageBox>
 #include <QSharedPointer>
 #include <QStringList>
 
@@ -54,6 +53,8 @@ private:
     public:                                             \
         _DerivedExc_( const QString &msg ) throw()      \
         : _BaseExc_( msg + "(" #_DerivedExc_ ")" ) {}   \
+        void raise() const { throw *this; }             \
+        QException * clone() const { return new _DerivedExc_( *this ); } \
     };
 
 TBOX_EXC_DECL( TemplateXmlLoadFailed, TinderBoxExc )
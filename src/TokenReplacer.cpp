@@ -0,0 +1,198 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "TokenReplacer.h"
+
+#include <QUuid>
+
+#include <cstring>
+
+namespace {
+
+const char kTokenPrefix[] = "_TBOX_";
+const int kTokenPrefixLength = sizeof( kTokenPrefix ) - 1;
+
+// the first 'c' in [p, end), or 'end'
+const char* findByte( const char *p, const char *end, char c )
+{
+	const char *result = (const char*)std::memchr( p, c, end - p );
+	return result ? result : end;
+}
+
+QByteArray createUuid()
+{
+	// toByteArray() is "{xxxxxxxx-xxxx-xxxx-xxxx-xxxxxxxxxxxx}"
+	return QUuid::createUuid().toByteArray().mid( 1, 36 ).toUpper();
+}
+
+} // anonymous namespace
+
+TokenReplacer::TokenReplacer()
+{
+}
+
+void TokenReplacer::setValue( const QByteArray &token, const QString &value )
+{
+	const QByteArray suffix = token.mid( kTokenPrefixLength );
+	for( QList<Token>::Iterator tokenIt = mTokens.begin(); tokenIt != mTokens.end(); ++tokenIt ) {
+		if( tokenIt->mSuffix == suffix ) {
+			tokenIt->mValue = value.toUtf8();
+			tokenIt->mUuidIndex = -1;
+			return;
+		}
+	}
+
+	Token result;
+	result.mSuffix = suffix;
+	result.mValue = value.toUtf8();
+	result.mUuidIndex = -1;
+	result.mLowerCase = false;
+	mTokens.append( result );
+}
+
+void TokenReplacer::addUuidTokens()
+{
+	for( int u = 0; u < 3; ++u ) {
+		Token upper;
+		upper.mSuffix = "UUID_" + QByteArray::number( u ) + "_";
+		upper.mUuidIndex = u;
+		upper.mLowerCase = false;
+		mTokens.append( upper );
+
+		Token lower = upper;
+		lower.mSuffix = "LOWER_" + upper.mSuffix;
+		lower.mLowerCase = true;
+		mTokens.append( lower );
+	}
+}
+
+QByteArray TokenReplacer::replace( const char *data, qint64 size, const char *lineEnding ) const
+{
+	const char *p = data;
+	const char *end = data + size;
+
+	// skip a UTF-8 byte order mark
+	if( ( size >= 3 ) && ( std::memcmp( p, "\xEF\xBB\xBF", 3 ) == 0 ) )
+		p += 3;
+
+	const char *begin = p;
+	const int lineEndingLength = lineEnding ? (int)std::strlen( lineEnding ) : 0;
+	// line endings already in the target form stay part of the current run
+	const bool keepLf = lineEnding && ( std::strcmp( lineEnding, "\n" ) == 0 );
+	const bool keepCrLf = lineEnding && ( std::strcmp( lineEnding, "\r\n" ) == 0 );
+
+	// tokens rarely grow a file by much; leave a little room for them and for wider line endings
+	QByteArray result;
+	result.reserve( (int)( ( end - p ) + ( ( lineEndingLength > 1 ) ? ( end - p ) / 16 : 0 ) + 256 ) );
+
+	QByteArray uuids[3];
+
+	const char *runStart = p;
+	const char *nextUnderscore = findByte( p, end, '_' );
+	const char *nextNewline = lineEnding ? findByte( p, end, '\n' ) : end;
+	while( p < end ) {
+		// jump to the next byte that might need attention; each search is only repeated once it has been passed
+		if( nextUnderscore < p )
+			nextUnderscore = findByte( p, end, '_' );
+		if( nextNewline < p )
+			nextNewline = findByte( p, end, '\n' );
+		p = qMin( nextUnderscore, nextNewline );
+		if( p >= end )
+			break;
+
+		if( *p == '\n' ) {
+			const bool crLf = ( p > runStart ) && ( *( p - 1 ) == '\r' );
+			if( crLf ? keepCrLf : keepLf ) {
+				++p;
+				continue;
+			}
+			const char *runEnd = crLf ? ( p - 1 ) : p;
+			result.append( runStart, (int)( runEnd - runStart ) );
+			result.append( lineEnding, lineEndingLength );
+			runStart = ++p;
+			continue;
+		}
+
+		// *p == '_'
+		const int matchIndex = matchAt( p, end );
+		if( matchIndex < 0 ) {
+			++p;
+			continue;
+		}
+		const Token *match = &mTokens[matchIndex];
+
+		result.append( runStart, (int)( p - runStart ) );
+		if( match->mUuidIndex >= 0 ) {
+			QByteArray &uuid = uuids[match->mUuidIndex];
+			if( uuid.isEmpty() )
+				uuid = createUuid();
+			result.append( match->mLowerCase ? uuid.toLower() : uuid );
+		}
+		else
+			result.append( match->mValue );
+		p += kTokenPrefixLength + match->mSuffix.size();
+		runStart = p;
+	}
+
+	if( lineEnding ) {
+		// a final line without a line ending still gets one; a trailing '\r' goes with it
+		const bool unterminated = ( end > begin ) && ( *( end - 1 ) != '\n' );
+		const char *runEnd = ( unterminated && ( runStart < end ) && ( *( end - 1 ) == '\r' ) ) ? ( end - 1 ) : end;
+		result.append( runStart, (int)( runEnd - runStart ) );
+		if( unterminated )
+			result.append( lineEnding, lineEndingLength );
+	}
+	else
+		result.append( runStart, (int)( end - runStart ) );
+
+	return result;
+}
+
+const char* TokenReplacer::findToken( const char *p, const char *end, int *tokenIndex, int *tokenLength ) const
+{
+	for( p = findByte( p, end, '_' ); p < end; p = findByte( p + 1, end, '_' ) ) {
+		const int index = matchAt( p, end );
+		if( index >= 0 ) {
+			*tokenIndex = index;
+			*tokenLength = kTokenPrefixLength + mTokens[index].mSuffix.size();
+			return p;
+		}
+	}
+
+	return end;
+}
+
+int TokenReplacer::matchAt( const char *p, const char *end ) const
+{
+	if( ( ( end - p ) <= kTokenPrefixLength ) || ( std::memcmp( p, kTokenPrefix, kTokenPrefixLength ) != 0 ) )
+		return -1;
+
+	const char *suffix = p + kTokenPrefixLength;
+	for( int t = 0; t < mTokens.size(); ++t ) {
+		const QByteArray &tokenSuffix = mTokens[t].mSuffix;
+		if( ( ( end - suffix ) >= tokenSuffix.size() ) && ( std::memcmp( suffix, tokenSuffix.constData(), tokenSuffix.size() ) == 0 ) )
+			return t;
+	}
+
+	return -1;
+}
@@ -0,0 +1,62 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+// Substitutes TinderBox's "_TBOX_..._" tokens in UTF-8 text with a single scan of the bytes. Only occurrences of
+// "_TBOX_" are examined further, so text without tokens is copied through in large runs.
+class TokenReplacer {
+  public:
+	TokenReplacer();
+
+	// 'token' is the complete token, such as "_TBOX_PREFIX_"; a later value for the same token replaces the earlier one
+	void		setValue( const QByteArray &token, const QString &value );
+	// _TBOX_UUID_0_ through _TBOX_UUID_2_ and their _TBOX_LOWER_UUID_n_ counterparts. Each replace() call creates its
+	// own UUIDs, and only on first use, so files without these tokens never pay for QUuid::createUuid()
+	void		addUuidTokens();
+
+	// Returns 'size' bytes of 'data' with every token replaced. When 'lineEnding' is non-null, "\n" and "\r\n" are
+	// rewritten as 'lineEnding' and a final line lacking one gets it appended. A leading UTF-8 byte order mark is dropped.
+	QByteArray	replace( const char *data, qint64 size, const char *lineEnding = 0 ) const;
+
+	// The scanner replace() uses: returns the first token in [p, end), or 'end' if there is none, setting 'tokenIndex'
+	// to the order in which the token was first given to setValue() or addUuidTokens() and 'tokenLength' to its length
+	const char*	findToken( const char *p, const char *end, int *tokenIndex, int *tokenLength ) const;
+
+  private:
+	struct Token {
+		QByteArray	mSuffix; // the token less its "_TBOX_" prefix
+		QByteArray	mValue;
+		int			mUuidIndex; // -1 for a fixed value
+		bool		mLowerCase;
+	};
+
+	// the index of the token starting at 'p', which is known to be '_', or -1
+	int				matchAt( const char *p, const char *end ) const;
+
+	QList<Token>	mTokens;
+};
@@ -0,0 +1,126 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "Trace.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+
+#include <iostream>
+
+bool Trace::sEnabled = false;
+
+namespace {
+
+struct Event {
+	const char	*mName;
+	qint64		mStart, mDuration;
+	quintptr	mThreadId;
+};
+
+QMutex				sMutex;
+QVector<Event>		sEvents;
+QElapsedTimer		sTimer;
+QString				sOutputPath;
+
+} // anonymous namespace
+
+void Trace::start( const QString &outputPath )
+{
+	QMutexLocker lock( &sMutex );
+	sEvents.clear();
+	sOutputPath = outputPath;
+	sTimer.start();
+	sEnabled = true;
+}
+
+void Trace::startFromEnvironment()
+{
+	const QByteArray path = qgetenv( "TINDERBOX_TRACE" );
+	if( ! path.isEmpty() )
+		start( QString::fromLocal8Bit( path ) );
+}
+
+qint64 Trace::now()
+{
+	return sTimer.nsecsElapsed() / 1000;
+}
+
+void Trace::record( const char *name, qint64 startMicros, qint64 endMicros )
+{
+	Event event;
+	event.mName = name;
+	event.mStart = startMicros;
+	event.mDuration = endMicros - startMicros;
+	event.mThreadId = (quintptr)QThread::currentThreadId();
+
+	QMutexLocker lock( &sMutex );
+	sEvents.push_back( event );
+}
+
+void Trace::finish()
+{
+	if( ! sEnabled )
+		return;
+	sEnabled = false;
+
+	QMutexLocker lock( &sMutex );
+	// Chrome wants small thread ids
+	QVector<quintptr> threadIds;
+	QJsonArray events;
+	for( QVector<Event>::ConstIterator eventIt = sEvents.constBegin(); eventIt != sEvents.constEnd(); ++eventIt ) {
+		int tid = threadIds.indexOf( eventIt->mThreadId );
+		if( tid < 0 ) {
+			tid = threadIds.size();
+			threadIds.push_back( eventIt->mThreadId );
+		}
+
+		QJsonObject event;
+		event["name"] = QString::fromUtf8( eventIt->mName );
+		event["cat"] = QString( "tinderbox" );
+		event["ph"] = QString( "X" );
+		event["ts"] = (double)eventIt->mStart;
+		event["dur"] = (double)eventIt->mDuration;
+		event["pid"] = 1;
+		event["tid"] = tid;
+		events.append( event );
+	}
+	sEvents.clear();
+
+	QJsonObject root;
+	root["traceEvents"] = events;
+	root["displayTimeUnit"] = QString( "ms" );
+
+	QFile file( sOutputPath );
+	if( ! file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+		std::cerr << "Couldn't write trace to " << sOutputPath.toStdString() << std::endl;
+		return;
+	}
+	file.write( QJsonDocument( root ).toJson( QJsonDocument::Compact ) );
+}
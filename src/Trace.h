@@ -0,0 +1,65 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include <QString>
+#include <QtGlobal>
+
+// Scoped timers recorded as Chrome trace events (chrome://tracing, ui.perfetto.dev). Recording is off unless
+// start() is called, ie via the TINDERBOX_TRACE environment variable or the CLI's --trace flag; while it is off
+// a TBOX_TRACE_SCOPE costs a single test of a bool.
+class Trace {
+  public:
+	class Scope {
+	  public:
+		// 'name' must outlive the trace, ie a string literal
+		explicit Scope( const char *name )
+			: mName( sEnabled ? name : NULL ), mStart( sEnabled ? now() : 0 )
+		{}
+		~Scope() { if( mName ) record( mName, mStart, now() ); }
+
+	  private:
+		const char	*mName;
+		qint64		mStart;
+	};
+
+	static bool		isEnabled() { return sEnabled; }
+	// begins recording events, to be written to 'outputPath' by finish()
+	static void		start( const QString &outputPath );
+	// calls start() with $TINDERBOX_TRACE if it is set
+	static void		startFromEnvironment();
+	// writes the recorded events and stops recording
+	static void		finish();
+
+  private:
+	static qint64	now();
+	static void		record( const char *name, qint64 startMicros, qint64 endMicros );
+
+	// only changed by start() and finish(), before and after any threads that record
+	static bool		sEnabled;
+};
+
+#define TBOX_TRACE_CONCAT_IMPL( _a_, _b_ )	_a_##_b_
+#define TBOX_TRACE_CONCAT( _a_, _b_ )		TBOX_TRACE_CONCAT_IMPL( _a_, _b_ )
+#define TBOX_TRACE_SCOPE( _name_ )			Trace::Scope TBOX_TRACE_CONCAT( traceScope, __LINE__ )( _name_ )
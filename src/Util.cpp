@@ -23,15 +23,31 @@
 
 #include "TinderBox.h"
 #include "Util.h"
+#include "TokenReplacer.h"
+#include "CompiledTemplate.h"
 
-#include <QApplication>
+#include <QCoreApplication>
+#include <QCryptographicHash>
 #include <QDir>
-#include <QMessageBox>
-#include <QUuid>
+#include <QPair>
+#include <QtConcurrent/QtConcurrentMap>
 #include <iostream>
 
+#if defined( Q_OS_UNIX )
+	#include <unistd.h>
+#endif
+#if defined( Q_OS_LINUX )
+	#include <fcntl.h>
+	#include <sys/ioctl.h>
+	#include <sys/stat.h>
+	#include <linux/fs.h>
+	#if defined( __GLIBC__ ) && ( ( __GLIBC__ > 2 ) || ( ( __GLIBC__ == 2 ) && ( __GLIBC_MINOR__ >= 27 ) ) )
+		#define TBOX_HAS_COPY_FILE_RANGE
+	#endif
+#endif
+
 QString getAppDirPath() {
-    QString appDirPath = QApplication::applicationDirPath();
+    QString appDirPath = QCoreApplication::applicationDirPath();
 #if defined Q_OS_MAC
     QDir appDir( appDirPath );
     appDir.cd( "../../.." );
@@ -81,43 +97,213 @@ bool makePath( const QString &path )
     return parent.mkpath( dir.dirName() );
 }
 
-void copyDir( const QString &srcPath, const QString &dstPath, bool overwriteExisting )
+CopyMode copyModeFromString( const QString &str )
 {
-	QDir sourceDir( srcPath );
-	if( ! sourceDir.exists() )
-		throw GenerateFailed( "Couldn't find directory:" + srcPath );
+	if( str.compare( "hardlink", Qt::CaseInsensitive ) == 0 )
+		return COPY_MODE_HARDLINK;
+	else if( str.compare( "symlink", Qt::CaseInsensitive ) == 0 )
+		return COPY_MODE_SYMLINK;
+	return COPY_MODE_COPY;
+}
 
-	QDir destDir( dstPath );
-	if( ! destDir.exists() ) {
-		if( ! QDir::root().mkpath( dstPath ) )
-			throw GenerateFailed( "Couldn't create directory:" + dstPath );
+QString copyModeToString( CopyMode mode )
+{
+	switch( mode ) {
+		case COPY_MODE_HARDLINK: return "hardlink";
+		case COPY_MODE_SYMLINK: return "symlink";
+		default: return "copy";
 	}
+}
 
-	QStringList files = sourceDir.entryList(QDir::Files);
-	for( int i = 0; i< files.count(); i++ ) {
-		QString srcName = srcPath + QDir::separator() + files[i];
-		QString destName = dstPath + QDir::separator() + files[i];
-		if( overwriteExisting && QFile::exists( destName ) )
-			QFile::remove( destName );
-		QFile::copy( srcName, destName );
+#if defined( Q_OS_LINUX )
+// Clones 'srcPath' into a new 'dstPath', or failing that copies it without leaving the kernel; on failure nothing is left at 'dstPath'
+static bool kernelCopyFile( const QString &srcPath, const QString &dstPath )
+{
+	const QByteArray dstName = QFile::encodeName( dstPath );
+	int srcFd = ::open( QFile::encodeName( srcPath ).constData(), O_RDONLY | O_CLOEXEC );
+	if( srcFd < 0 )
+		return false;
+
+	struct stat srcStat;
+	if( ::fstat( srcFd, &srcStat ) != 0 ) {
+		::close( srcFd );
+		return false;
 	}
-	files.clear();
-	files = sourceDir.entryList( QDir::AllDirs | QDir::NoDotAndDotDot );
-	for( int i = 0; i< files.count(); i++ ) {
-		QString srcName = srcPath + QDir::separator() + files[i];
-		QString destName = dstPath + QDir::separator() + files[i];
-		copyDir( srcName, destName, overwriteExisting );
+
+	int dstFd = ::open( dstName.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, srcStat.st_mode & 0777 );
+	if( dstFd < 0 ) {
+		::close( srcFd );
+		return false;
+	}
+
+	bool copied = false;
+#if defined( FICLONE )
+	copied = ::ioctl( dstFd, FICLONE, srcFd ) == 0;
+#endif
+#if defined( TBOX_HAS_COPY_FILE_RANGE )
+	if( ! copied ) {
+		copied = true;
+		for( off_t remaining = srcStat.st_size; remaining > 0; ) {
+			ssize_t written = ::copy_file_range( srcFd, NULL, dstFd, NULL, (size_t)remaining, 0 );
+			if( written <= 0 ) {
+				copied = false;
+				break;
+			}
+			remaining -= written;
+		}
+	}
+#endif
+
+	::close( srcFd );
+	::close( dstFd );
+	if( ! copied )
+		::unlink( dstName.constData() );
+	return copied;
+}
+#endif
+
+bool copyFileContents( const QString &srcPath, const QString &dstPath, CopyMode mode )
+{
+#if defined( Q_OS_UNIX )
+	if( ( mode == COPY_MODE_HARDLINK ) && ( ::link( QFile::encodeName( srcPath ).constData(), QFile::encodeName( dstPath ).constData() ) == 0 ) )
+		return true;
+	if( ( mode == COPY_MODE_SYMLINK ) && QFile::link( srcPath, dstPath ) )
+		return true;
+#endif
+#if defined( Q_OS_LINUX )
+	if( kernelCopyFile( srcPath, dstPath ) )
+		return true;
+#endif
+	return QFile::copy( srcPath, dstPath );
+}
+
+CopyStats& CopyStats::operator+=( const CopyStats &rhs )
+{
+	mFilesCopied += rhs.mFilesCopied;
+	mFilesSkipped += rhs.mFilesSkipped;
+	mBytesCopied += rhs.mBytesCopied;
+	return *this;
+}
+
+static bool sameContents( const QString &pathA, const QString &pathB )
+{
+	QFile fileA( pathA ), fileB( pathB );
+	if( ( ! fileA.open( QFile::ReadOnly ) ) || ( ! fileB.open( QFile::ReadOnly ) ) )
+		return false;
+	QCryptographicHash hashA( QCryptographicHash::Sha1 ), hashB( QCryptographicHash::Sha1 );
+	return hashA.addData( &fileA ) && hashB.addData( &fileB ) && ( hashA.result() == hashB.result() );
+}
+
+// gives a fresh copy the source's permissions and modification time, so a later updateFile() can recognize it. Only
+// what differs is set: a link already has the source's attributes, and setting them through a hard link would touch the source
+static void copyFileAttributes( const QFileInfo &src, const QString &dstPath )
+{
+	const QFileInfo dst( dstPath );
+	if( dst.isSymLink() )
+		return;
+	QFile::Permissions dstPermissions = dst.permissions();
+#if QT_VERSION >= QT_VERSION_CHECK( 5, 10, 0 )
+	// the time is set through a writable handle, so a read-only copy stays writable until its mode is set below
+	if( dst.lastModified() != src.lastModified() ) {
+		if( ! ( dstPermissions & QFile::WriteOwner ) ) {
+			dstPermissions |= QFile::WriteOwner;
+			QFile::setPermissions( dstPath, dstPermissions );
+		}
+		QFile dstFile( dstPath );
+		if( dstFile.open( QFile::Append ) )
+			dstFile.setFileTime( src.lastModified(), QFileDevice::FileModificationTime );
+	}
+#endif
+	if( dstPermissions != src.permissions() )
+		QFile::setPermissions( dstPath, src.permissions() );
+}
+
+// Brings 'dstPath' up to date with 'src'. An existing destination is left alone unless 'overwriteExisting', and then
+// only replaced if its size or modification time (or with 'compareContents', its data) differ. Returns false on failure
+static bool updateFile( const QFileInfo &src, const QString &dstPath, bool overwriteExisting, CopyMode mode, bool compareContents, CopyStats *stats )
+{
+	const QFileInfo dst( dstPath );
+	if( dst.exists() ) {
+		if( ( ! overwriteExisting ) ||
+			( ( dst.size() == src.size() ) && ( dst.lastModified() == src.lastModified() ) && ( ( ! compareContents ) || sameContents( src.absoluteFilePath(), dstPath ) ) ) ) {
+			++stats->mFilesSkipped;
+			return true;
+		}
+		QFile::remove( dstPath );
 	}
+
+	if( ! copyFileContents( src.absoluteFilePath(), dstPath, mode ) )
+		return false;
+	copyFileAttributes( src, dstPath );
+	++stats->mFilesCopied;
+	stats->mBytesCopied += src.size();
+	return true;
+}
+
+namespace {
+// one file of a copyDir(), copied on whichever thread QtConcurrent hands it to
+struct TreeFile {
+	QFileInfo	mSrc;
+	QString		mDstPath;
+	bool		mOverwriteExisting, mCompareContents;
+	CopyMode	mMode;
+	bool		mSucceeded;
+	CopyStats	mStats;
+};
+
+void copyTreeFile( TreeFile &file )
+{
+	file.mSucceeded = updateFile( file.mSrc, file.mDstPath, file.mOverwriteExisting, file.mMode, file.mCompareContents, &file.mStats );
 }
+} // anonymous namespace
 
-void copyFileOrDir( QFileInfo src, QFileInfo dst, bool overwriteExisting, bool replaceContents, const QString &replacePrefix, bool windowsLineEndings )
+CopyStats copyDir( const QString &srcPath, const QString &dstPath, bool overwriteExisting, CopyMode mode, bool compareContents )
 {
-	// test immediately for the destination already existing. Remove it if we should
-	bool dstExists = dst.exists();
-	if( dstExists && overwriteExisting ) {
-		QFile::remove( dst.absoluteFilePath() );
+	QDir sourceDir( srcPath );
+	if( ! sourceDir.exists() )
+		throw GenerateFailed( "Couldn't find directory:" + srcPath );
+
+	// walk the tree breadth-first, creating directories as we go and collecting the files
+	QList<TreeFile> files;
+	QList<QPair<QString,QString> > dirQueue;
+	dirQueue.append( qMakePair( srcPath, dstPath ) );
+	while( ! dirQueue.isEmpty() ) {
+		const QPair<QString,QString> dir = dirQueue.takeFirst();
+
+		if( ! QDir( dir.second ).exists() ) {
+			if( ! QDir::root().mkpath( dir.second ) )
+				throw GenerateFailed( "Couldn't create directory:" + dir.second );
+		}
+
+		QDir currentDir( dir.first );
+		const QFileInfoList entries = currentDir.entryInfoList( QDir::Files );
+		for( QFileInfoList::ConstIterator entryIt = entries.begin(); entryIt != entries.end(); ++entryIt ) {
+			TreeFile file;
+			file.mSrc = *entryIt;
+			file.mDstPath = dir.second + QDir::separator() + entryIt->fileName();
+			file.mOverwriteExisting = overwriteExisting;
+			file.mCompareContents = compareContents;
+			file.mMode = mode;
+			file.mSucceeded = false;
+			files.append( file );
+		}
+
+		const QStringList subDirs = currentDir.entryList( QDir::AllDirs | QDir::NoDotAndDotDot );
+		for( QStringList::ConstIterator subDirIt = subDirs.begin(); subDirIt != subDirs.end(); ++subDirIt )
+			dirQueue.append( qMakePair( dir.first + QDir::separator() + *subDirIt, dir.second + QDir::separator() + *subDirIt ) );
 	}
 
+	// copy the files in parallel; as before, a file that can't be copied doesn't stop the rest
+	QtConcurrent::blockingMap( files, copyTreeFile );
+
+	CopyStats result;
+	for( QList<TreeFile>::ConstIterator fileIt = files.begin(); fileIt != files.end(); ++fileIt )
+		result += fileIt->mStats;
+	return result;
+}
+
+CopyStats copyFileOrDir( QFileInfo src, QFileInfo dst, bool overwriteExisting, bool replaceContents, const QString &replacePrefix, bool windowsLineEndings, CopyMode mode, bool compareContents )
+{
 	QString dstPath;
 	QString srcPath = src.absoluteFilePath();
 
@@ -126,12 +312,30 @@ void copyFileOrDir( QFileInfo src, QFileInfo dst, bool overwriteExisting, bool r
 	dstPath = dst.absoluteFilePath();
 
 	if( src.isDir() )
-		copyDir( srcPath, dstPath, overwriteExisting );
-	else if( ( ! dstExists ) || overwriteExisting )
-		copyFile( QFileInfo( srcPath ), QFileInfo( dstPath ), replaceContents, replacePrefix, windowsLineEndings );
+		return copyDir( srcPath, dstPath, overwriteExisting, mode, compareContents );
+
+	CopyStats result;
+	if( replaceContents ) {
+		// replaced contents can't be compared against the source, so these are always rewritten
+		const bool dstExists = dst.exists();
+		if( dstExists && ( ! overwriteExisting ) ) {
+			++result.mFilesSkipped;
+			return result;
+		}
+		if( dstExists )
+			QFile::remove( dstPath );
+		if( copyFile( QFileInfo( srcPath ), QFileInfo( dstPath ), replaceContents, replacePrefix, windowsLineEndings, mode ) ) {
+			++result.mFilesCopied;
+			result.mBytesCopied += QFileInfo( dstPath ).size();
+		}
+	}
+	else if( ! updateFile( src, dstPath, overwriteExisting, mode, compareContents, &result ) )
+		throw GenerateFailed( "Unable to copy from " + srcPath + " to " + dstPath );
+
+	return result;
 }
 
-void copyFile( QFileInfo src, QFileInfo dst, bool replaceContents, QString replacePrefix, bool windowsLineEndings )
+bool copyFile( QFileInfo src, QFileInfo dst, bool replaceContents, QString replacePrefix, bool windowsLineEndings, CopyMode mode )
 {
 	QString dstPath;
 	QString srcPath = src.absoluteFilePath();
@@ -142,64 +346,46 @@ void copyFile( QFileInfo src, QFileInfo dst, bool replaceContents, QString repla
 
 	if( replaceContents ) {
 		if( QFileInfo( srcPath ).fileName() == QString( "_TBOX_IGNORE_" ) )
-			return;
+			return false;
 
 		QFile srcFile( srcPath );
 
-		if( ! srcFile.open( QFile::ReadOnly | QFile::Text ) ) {
+		// line endings are normalized by the replacer, so no QFile::Text here
+		if( ! srcFile.open( QFile::ReadOnly ) ) {
 			throw GenerateFailed( "Couldn't open file for reading: " + srcPath );
 		}
 
+		TokenReplacer replacer;
+		replacer.setValue( "_TBOX_PREFIX_", replacePrefix );
+		replacer.setValue( "_TBOX_PROJECT_", replacePrefix );
+		replacer.addUuidTokens();
+
+		const char *lineEnding = windowsLineEndings ? "\r\n" : "\n";
+		QByteArray contents;
+		const qint64 srcSize = srcFile.size();
+		const uchar *mapped = ( srcSize > 0 ) ? srcFile.map( 0, srcSize ) : 0;
+		if( mapped ) {
+			contents = replacer.replace( (const char*)mapped, srcSize, lineEnding );
+			srcFile.unmap( const_cast<uchar*>( mapped ) );
+		}
+		else {
+			const QByteArray srcContents = srcFile.readAll();
+			contents = replacer.replace( srcContents.constData(), srcContents.size(), lineEnding );
+		}
+
 		QFile dstFile( dstPath );
 		if( ! dstFile.open( QFile::WriteOnly ) ) {
 			throw GenerateFailed( "Couldn't open file for writing: " + dstPath );
 		}
-
-		QTextStream srcStream( &srcFile );
-		QTextStream dstStream( &dstFile );
-
-		srcStream.setAutoDetectUnicode( false );
-		srcStream.setCodec( "UTF-8" );
-		dstStream.setCodec( "UTF-8" );
-		dstStream.setGenerateByteOrderMark( false );
-
-		const QString kTBoxPrefix           = "_TBOX_PREFIX_";
-		const QString kTBoxProject          = "_TBOX_PROJECT_";
-		const QString kUuid0				= "_TBOX_UUID_0_";
-		const QString kUuid1				= "_TBOX_UUID_1_";
-		const QString kUuid2				= "_TBOX_UUID_2_";
-		const QString kLowerUuid0			= "_TBOX_LOWER_UUID_0_";
-		const QString kLowerUuid1			= "_TBOX_LOWER_UUID_1_";
-		const QString kLowerUuid2			= "_TBOX_LOWER_UUID_2_";
-
-		QString uuids[3];
-		uuids[0] = QUuid::createUuid().toString().toUpper().replace( "{", "" ).replace( "}", "" );
-		uuids[1] = QUuid::createUuid().toString().toUpper().replace( "{", "" ).replace( "}", "" );;
-		uuids[2] = QUuid::createUuid().toString().toUpper().replace( "{", "" ).replace( "}", "" );;
-		QString lowerUuids[3];
-		lowerUuids[0] = uuids[0].toLower();
-		lowerUuids[1] = uuids[1].toLower();
-		lowerUuids[2] = uuids[2].toLower();
-
-		while( ! srcStream.atEnd() ) {
-			QString line = srcStream.readLine();
-			line.replace( kTBoxPrefix, replacePrefix );
-			line.replace( kTBoxProject, replacePrefix );
-
-			line.replace( kUuid0, uuids[0] );
-			line.replace( kUuid1, uuids[1] );
-			line.replace( kUuid2, uuids[2] );
-			line.replace( kLowerUuid0, lowerUuids[0] );
-			line.replace( kLowerUuid1, lowerUuids[1] );
-			line.replace( kLowerUuid2, lowerUuids[2] );
-
-			dstStream << line << ( windowsLineEndings ? "\r\n" : "\n" );
+		if( dstFile.write( contents ) != contents.size() ) {
+			throw GenerateFailed( "Couldn't write file: " + dstPath );
 		}
 	}
 	else {
-		if( ! QFile::copy( srcPath, dstPath ) )
+		if( ! copyFileContents( srcPath, dstPath, mode ) )
 			throw GenerateFailed( "Unable to copy from " + srcPath + " to " + dstPath );
 	}
+	return true;
 }
 
 std::string toWinPath( const std::string &path )
@@ -211,59 +397,9 @@ std::string toWinPath( const std::string &path )
 
 QString loadAndStringReplace( QFileInfo path, QString replacePrefix, QString cinderPath )
 {
-	QFile srcFile( path.absoluteFilePath() );
-	if( ! srcFile.open( QFile::ReadOnly | QFile::Text ) ) {
-		throw GenerateFailed( "Couldn't open file for reading: " + path.absoluteFilePath() );
-	}
-
-	QTextStream srcStream( &srcFile );
-
-	srcStream.setAutoDetectUnicode( false );
-	srcStream.setCodec( "UTF-8" );
-
-	const QString kTBoxPrefix             = "_TBOX_PREFIX_";
-	const QString kTBoxProject            = "_TBOX_PROJECT_";
-	const QString kTBoxCinderPathToken    = "_TBOX_CINDER_PATH_";
-
-	QString contents = srcStream.readAll();
-	contents.replace( kTBoxPrefix, replacePrefix );
-	contents.replace( kTBoxProject, replacePrefix );
-	contents.replace( kTBoxCinderPathToken, cinderPath );
-	
-	return contents;
-}
-
-void showErrorMsg( const QString &msg, const QString &heading )
-{
-    QMessageBox msgBox;
-    msgBox.setIcon( QMessageBox::Critical );
-    msgBox.setText( heading );
-    msgBox.setInformativeText( msg );
-    msgBox.setStandardButtons( QMessageBox::Ok );
-    msgBox.setDefaultButton( QMessageBox::Ok );
-    msgBox.exec();
-}
-
-bool showConfirmMsg( const QString &msg, const QString &heading )
-{
-    QMessageBox msgBox;
-    msgBox.setIcon( QMessageBox::Question );
-    msgBox.setText( heading );
-    msgBox.setInformativeText( msg );
-    msgBox.setStandardButtons( QMessageBox::Yes | QMessageBox::No );
-    msgBox.setDefaultButton( QMessageBox::Yes );
-    int ret = msgBox.exec();
-    return QMessageBox::Yes == ret;
-}
+	QString values[CompiledTemplate::SLOT_COUNT];
+	values[CompiledTemplate::SLOT_PREFIX] = replacePrefix;
+	values[CompiledTemplate::SLOT_CINDER_PATH] = cinderPath;
 
-void showOkMsg( const QString &msg, const QString &heading )
-{
-    QMessageBox msgBox;
-    msgBox.setIcon( QMessageBox::Question );
-    msgBox.setText( heading );
-    msgBox.setInformativeText( msg );
-    msgBox.setStandardButtons( QMessageBox::Ok );
-    msgBox.setDefaultButton( QMessageBox::Ok );
-    msgBox.exec();
+	return CompiledTemplate::load( path )->instantiate( values );
 }
-
@@ -33,17 +33,37 @@ QString joinPathMac( const QString &a, const QString &b );
 bool dirExists( const QString &path );
 bool fileExists( const QString &path );
 bool makePath( const QString &path );
-void copyDir( const QString &srcPath, const QString &dstPath, bool overwriteExisting );
 
-// Treats duplicate as a non-failure
-void copyFileOrDir( QFileInfo src, QFileInfo dst, bool overwriteExisting, bool replaceContents = false, const QString &replacePrefix = "", bool windowsLineEndings = false );
-void copyFile( QFileInfo src, QFileInfo dst, bool replaceContents, QString replacePrefix, bool windowsLineEndings );
+// How files whose contents aren't rewritten are materialized. Linking is opt-in since the output then shares
+// its data with the (read-only) input; when a link can't be made, ie across devices, a copy is made instead.
+typedef enum { COPY_MODE_COPY, COPY_MODE_HARDLINK, COPY_MODE_SYMLINK } CopyMode;
 
-std::string toWinPath( const std::string &path );
+CopyMode	copyModeFromString( const QString &str );
+QString		copyModeToString( CopyMode mode );
+
+// what a copyDir() or copyFileOrDir() did; a file is skipped when its destination exists and is kept
+struct CopyStats {
+	CopyStats() : mFilesCopied( 0 ), mFilesSkipped( 0 ), mBytesCopied( 0 ) {}
+
+	CopyStats&	operator+=( const CopyStats &rhs );
+
+	int			mFilesCopied, mFilesSkipped;
+	qint64		mBytesCopied;
+};
 
-// Error message handling
-void showErrorMsg( const QString &msg, const QString &heading = "" );
-bool showConfirmMsg( const QString &msg, const QString &heading = "" );
-void showOkMsg( const QString &msg, const QString &heading = "" );
+// Copies the tree's files in parallel. With 'overwriteExisting', destination files whose size and modification time
+// match the source (and with 'compareContents', whose data does too) are kept; copies get the source's permissions and mtime
+CopyStats copyDir( const QString &srcPath, const QString &dstPath, bool overwriteExisting, CopyMode mode = COPY_MODE_COPY, bool compareContents = false );
+
+// Treats duplicate as a non-failure; 'compareContents' as for copyDir(), and for single files whose contents aren't replaced
+CopyStats copyFileOrDir( QFileInfo src, QFileInfo dst, bool overwriteExisting, bool replaceContents = false, const QString &replacePrefix = "", bool windowsLineEndings = false,
+					CopyMode mode = COPY_MODE_COPY, bool compareContents = false );
+// false if nothing was written, ie for a _TBOX_IGNORE_ placeholder
+bool copyFile( QFileInfo src, QFileInfo dst, bool replaceContents, QString replacePrefix, bool windowsLineEndings, CopyMode mode = COPY_MODE_COPY );
+// Links or copies 'srcPath' to the not-yet-existing 'dstPath' per 'mode'; regular copies are cloned (FICLONE) or
+// copied in-kernel (copy_file_range) on Linux when the filesystem supports it
+bool copyFileContents( const QString &srcPath, const QString &dstPath, CopyMode mode );
+
+std::string toWinPath( const std::string &path );
 
 QString loadAndStringReplace( QFileInfo path, QString replacePrefix, QString cinderPath );
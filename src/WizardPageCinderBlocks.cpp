@@ -23,8 +23,10 @@
 
 #include "WizardPageCinderBlocks.h"
 #include "CinderBlockManager.h"
+#include "ErrorListDialog.h"
 #include "ui_WizardPageCinderBlocks.h"
 
+#include <QMultiMap>
 #include <QPainter>
 #include <QStandardItemModel>
 #include <iostream>
@@ -44,6 +46,22 @@ static const QColor SHADOW_COLOR( QColor( 245, 245, 245, 220 ) );
 static const QColor HIGHLIGHTED_COLOR( QColor( 70, 70, 70 ) );
 static const QColor HIGHLIGHTED_SHADOW_COLOR( QColor( 48, 48, 48, 220 ) );
 
+// icons are loaded on first use and kept until the blocks are rescanned; the scan itself stays free of GUI types
+static QMap<QString,QIcon> sIconCache;
+
+static const QIcon& getCinderBlockIcon( const QString &path )
+{
+	static QIcon defaultIcon( ":/resources/GenericCinderBlock.png" );
+	if( path.isEmpty() )
+		return defaultIcon;
+
+	QMap<QString,QIcon>::Iterator iconIt = sIconCache.find( path );
+	if( iconIt == sIconCache.end() )
+		iconIt = sIconCache.insert( path, QIcon( path ) );
+
+	return iconIt.value();
+}
+
 
 void CinderBlockItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &index) const
 {
@@ -86,7 +104,7 @@ void CinderBlockItemDelegate::paint(QPainter *painter, const QStyleOptionViewIte
 			painter->fillRect( option.rect.adjusted( 0, 2, 0, -2 ), QBrush( grad ) );
 		}
 
-		const QIcon &icon = CinderBlockManager::getIcon( iconPath );
+		const QIcon &icon = getCinderBlockIcon( iconPath );
 		icon.paint( painter, option.rect.left() + 6, option.rect.top() + 6, ICON_SIZE, ICON_SIZE );
 
 		QRect r = option.rect.adjusted(50, 0, 0, 0);
@@ -166,18 +184,49 @@ void WizardPageCinderBlocks::setCinderLocation( const QString &/*path*/ )
 
 void WizardPageCinderBlocks::updateCinderBlockList()
 {
-	ui->cinderBlockList->clear();
-
-	for( QList<CinderBlock>::ConstIterator blockIt = mParent->getCinderBlocks().begin(); blockIt != mParent->getCinderBlocks().end(); ++blockIt ) {
-		QListWidgetItem *item = new QListWidgetItem();
+	// a rescan may have changed any cinderblock.png
+	sIconCache.clear();
+
+	// rows are matched to the rescanned blocks by id and only added, moved, updated or removed where they differ, so
+	// unchanged blocks keep their rows and the current block stays selected if it's still there
+	QListWidget *list = ui->cinderBlockList;
+	QListWidgetItem *currentItem = list->currentItem();
+	QMultiMap<QString,QListWidgetItem*> previousItems;
+	for( int row = 0; row < list->count(); ++row )
+		previousItems.insert( list->item( row )->data( Qt::UserRole + 1 ).toString(), list->item( row ) );
+
+	int row = 0;
+	for( QList<CinderBlock>::ConstIterator blockIt = mParent->getCinderBlocks().begin(); blockIt != mParent->getCinderBlocks().end(); ++blockIt, ++row ) {
+		QListWidgetItem *item = 0;
+		QMultiMap<QString,QListWidgetItem*>::Iterator previousIt = previousItems.find( blockIt->getId() );
+		if( previousIt != previousItems.end() ) {
+			item = previousIt.value();
+			previousItems.erase( previousIt );
+			if( list->row( item ) != row )
+				list->insertItem( row, list->takeItem( list->row( item ) ) );
+		}
+		else {
+			item = new QListWidgetItem();
+			list->insertItem( row, item );
+		}
+		// setData() does nothing for an unchanged value
 		item->setData( Qt::DisplayRole, blockIt->getName() );
 		item->setData( Qt::UserRole + 1, blockIt->getId() );
 		item->setData( Qt::UserRole + 2, QVariant( (int)blockIt->getInstallType() ) );
 		item->setData( Qt::UserRole + 3, blockIt->getIconPath() );
-		ui->cinderBlockList->addItem( item );
+	}
+
+	// the blocks that are gone
+	for( QMultiMap<QString,QListWidgetItem*>::ConstIterator previousIt = previousItems.constBegin(); previousIt != previousItems.constEnd(); ++previousIt ) {
+		if( previousIt.value() == currentItem )
+			currentItem = 0;
+		delete previousIt.value();
 	}
 	
-	if( ui->cinderBlockList->count() > 0 ) {
+	if( currentItem ) {
+		ui->cinderBlockList->setCurrentItem( currentItem );
+	}
+	else if( ui->cinderBlockList->count() > 0 ) {
 		ui->cinderBlockList->setCurrentItem( ui->cinderBlockList->item( 0 ) );
 	}
 	
@@ -212,7 +261,9 @@ CinderBlock* WizardPageCinderBlocks::getCurrentCinderBlock()
 
 void WizardPageCinderBlocks::selectionChanged()
 {
-	const CinderBlock *currentCinderBlock = getCurrentCinderBlock();
+	CinderBlock *currentCinderBlock = getCurrentCinderBlock();
+	if( currentCinderBlock )
+		mParent->ensureCinderBlockParsed( currentCinderBlock );
 
 	// delete all existing items after the install combo	
 	while( ui->formLayout->count() > 4 ) {
@@ -223,7 +274,7 @@ void WizardPageCinderBlocks::selectionChanged()
 	
 	if( currentCinderBlock ) {
 		QString fullName = currentCinderBlock->getName();
-		const QIcon &icon = CinderBlockManager::getIcon( currentCinderBlock->getIconPath() );
+		const QIcon &icon = getCinderBlockIcon( currentCinderBlock->getIconPath() );
 		ui->nameLabel->setPixmap( icon.pixmap( 48 ) );
 		ui->nameContents->setText( fullName );
 		ui->nameId->setText( currentCinderBlock->getId() );
@@ -25,7 +25,7 @@
 #include "MainWizard.h"
 #include "Preferences.h"
 #include "FirstTimeDlg.h"
-#include "ErrorList.h"
+#include "ErrorListDialog.h"
 #include "ui_WizardPageMain.h"
 
 #include <QCloseEvent>
@@ -106,6 +106,16 @@ void WizardPageMain::setCinderLocationByIndex( int index )
 	updateTemplates();
 }
 
+// the ID of the template in a row of the template menu, empty for the separator
+QString WizardPageMain::templateIdAt( int row ) const
+{
+	QVariant tmplVar = ui->templateComboBox->itemData( row );
+	if( ! tmplVar.isValid() )
+		return QString();
+
+	return reinterpret_cast<const ProjectTemplate *>( tmplVar.value<void*>() )->getId();
+}
+
 void WizardPageMain::updateTemplates()
 {
 	// save the currently selected template's ID
@@ -122,26 +132,50 @@ void WizardPageMain::updateTemplates()
 		oldTemplateId = "org.libcinder.apptemplates.basicopengl";
 	}
 
-	ui->templateComboBox->clear();
+	// the rows still point into the previous list until they're replaced below
+	QList<ProjectTemplate> previousTemplates;
+	previousTemplates.swap( mProjectTemplates );
 
-	mProjectTemplates.clear();
-	
-	// add all the built-in templates
+	// the built-in templates, then a separator and all the CinderBlock templates; an empty ID marks the separator
+	QList<QString> newIds;
+	QList<const ProjectTemplate*> newRows;
 	const QList<ProjectTemplate> &templates = ProjectTemplateManager::getTemplates();
 	for( QList<ProjectTemplate>::ConstIterator tmplIt = templates.begin(); tmplIt != templates.end(); ++tmplIt ) {
 		mProjectTemplates.push_back( *tmplIt );
-		ui->templateComboBox->addItem( tmplIt->getName(), qVariantFromValue( (void*)(&mProjectTemplates.back() )) );
+		newIds.push_back( tmplIt->getId() );
+		newRows.push_back( &mProjectTemplates.back() );
 	}
-	
-	// add all the CinderBlock templates
+
 	const QList<ProjectTemplate> &cblockTemplates = CinderBlockManager::getProjectTemplates();
-	
-	if( ! cblockTemplates.empty() )
-		ui->templateComboBox->insertSeparator( ui->templateComboBox->count() );
+	if( ! cblockTemplates.empty() ) {
+		newIds.push_back( QString() );
+		newRows.push_back( 0 );
+	}
 	for( QList<ProjectTemplate>::ConstIterator tmplIt = cblockTemplates.begin(); tmplIt != cblockTemplates.end(); ++tmplIt ) {
 		mProjectTemplates.push_back( *tmplIt );
-		ui->templateComboBox->addItem( tmplIt->getName(), qVariantFromValue( (void*)(&mProjectTemplates.back() )) );
+		newIds.push_back( tmplIt->getId() );
+		newRows.push_back( &mProjectTemplates.back() );
+	}
+
+	// match the existing rows by ID so only the templates that were added, removed or moved are inserted or taken out
+	QComboBox *comboBox = ui->templateComboBox;
+	for( int row = 0; row < newIds.size(); ++row ) {
+		while( row < comboBox->count() && templateIdAt( row ) != newIds[row] && newIds.indexOf( templateIdAt( row ), row ) < 0 )
+			comboBox->removeItem( row );
+
+		if( row < comboBox->count() && templateIdAt( row ) == newIds[row] ) {
+			if( newRows[row] ) {
+				comboBox->setItemText( row, newRows[row]->getName() );
+				comboBox->setItemData( row, qVariantFromValue( (void*)newRows[row] ) );
+			}
+		}
+		else if( newRows[row] )
+			comboBox->insertItem( row, newRows[row]->getName(), qVariantFromValue( (void*)newRows[row] ) );
+		else
+			comboBox->insertSeparator( row );
 	}
+	while( comboBox->count() > newIds.size() )
+		comboBox->removeItem( comboBox->count() - 1 );
 	
 	// if we have a template with the same ID as the old ID, select that
 	for( QList<ProjectTemplate>::ConstIterator tmplIt = templates.begin(); tmplIt != templates.end(); ++tmplIt ) {
@@ -74,6 +74,7 @@ private:
     QList<QMap<QString,QString> >			mPlatformConditions;
 
 	QString				getTemplateValue() const;
+	QString				templateIdAt( int row ) const;
 	void				updateProjectNameStatus();
 	void                validateNextButton();
 
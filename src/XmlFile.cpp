@@ -0,0 +1,70 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "XmlFile.h"
+
+XmlFile::XmlFile( const QString &path, unsigned int parseOptions )
+	: mPath( path ), mFile( path ), mMapped( 0 )
+{
+	if( ! mFile.open( QFile::ReadOnly ) ) {
+		mResult.status = pugi::status_file_not_found;
+		return;
+	}
+
+	// a private mapping takes the parser's in-place edits without touching the file
+	const qint64 size = mFile.size();
+	if( size > 0 )
+		mMapped = mFile.map( 0, size, QFileDevice::MapPrivateOption );
+
+	if( mMapped )
+		mResult = mDocument.load_buffer_inplace( mMapped, (size_t)size, parseOptions );
+	else {
+		mBuffer = mFile.readAll();
+		mResult = mDocument.load_buffer_inplace( mBuffer.data(), (size_t)mBuffer.size(), parseOptions );
+	}
+}
+
+XmlFile::~XmlFile()
+{
+	// the document refers into the mapping, so it goes first
+	mDocument.reset();
+	if( mMapped )
+		mFile.unmap( mMapped );
+}
+
+QString XmlFile::getErrorDescription() const
+{
+	QString result = QString( mResult.description() );
+	if( mResult.offset <= 0 )
+		return result;
+
+	// the in-place parse has rewritten the buffer, so count lines in the original file
+	int line = 1;
+	QFile file( mPath );
+	if( file.open( QFile::ReadOnly ) ) {
+		const QByteArray prefix = file.read( mResult.offset );
+		line += prefix.count( '\n' );
+	}
+
+	return result + QString( " at line %1 (offset %2)" ).arg( line ).arg( (qint64)mResult.offset );
+}
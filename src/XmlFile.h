@@ -0,0 +1,59 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#pragma once
+
+#include "TinderBox.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+
+// Loads an XML file by mapping it copy-on-write and parsing it in place, so its text is never buffered or copied.
+// Node strings point into the mapping, so they are only valid for the lifetime of the XmlFile.
+class XmlFile {
+  public:
+	// what block and template manifests need: no PIs, comments, declaration or doctype. Whitespace in attribute values
+	// is normalized as before, so conditions and build settings reach generated projects without tabs or newlines
+	static const unsigned int kManifestParseOptions = pugi::parse_cdata | pugi::parse_escapes | pugi::parse_wconv_attribute | pugi::parse_eol;
+
+	explicit XmlFile( const QString &path, unsigned int parseOptions = kManifestParseOptions );
+	~XmlFile();
+
+	bool							isLoaded() const { return mResult; }
+	const pugi::xml_parse_result&	getResult() const { return mResult; }
+	pugi::xml_document&				getDocument() { return mDocument; }
+
+	// the parser's description of a failure, with the line and byte offset it happened at
+	QString		getErrorDescription() const;
+
+  private:
+	Q_DISABLE_COPY( XmlFile )
+
+	QString					mPath;
+	QFile					mFile;
+	uchar					*mMapped;
+	QByteArray				mBuffer; // when the file can't be mapped
+	pugi::xml_document		mDocument;
+	pugi::xml_parse_result	mResult;
+};
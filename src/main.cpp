@@ -24,12 +24,14 @@
 #include <QtWidgets>
 #include <QFontDatabase>
 #include "MainWizard.h"
+#include "Trace.h"
 
 #include <iostream>
 
 int main(int argc, char *argv[])
 {
 	QApplication a(argc, argv);
+	Trace::startFromEnvironment();
 	
 	QCoreApplication::setOrganizationName( "libcinder" );
 	QCoreApplication::setOrganizationDomain( "libcinder.org" );
@@ -52,5 +54,7 @@ int main(int argc, char *argv[])
 
 	wizard.show();
 	
-	return a.exec();
+	int result = a.exec();
+	Trace::finish();
+	return result;
 }
@@ -0,0 +1,230 @@
+/*
+ Copyright (c) 2015, The Cinder Project, All rights reserved.
+
+ This code is intended for use with the Cinder C++ library: http://libcinder.org
+
+ Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+ the following conditions are met:
+
+ * Redistributions of source code must retain the above copyright notice, this list of conditions and
+    the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+    the following disclaimer in the documentation and/or other materials provided with the distribution.
+
+ THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+ WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR
+ ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+ TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+ HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRegExp>
+
+#include "BatchGenerator.h"
+#include "Preferences.h"
+#include "Trace.h"
+
+#include <cstdio>
+#include <iostream>
+
+// "type[:option,...]", ie "vc2015:x64,angle". Listing any options disables the platforms that aren't listed
+static QJsonObject parseGenerator( const QString &str )
+{
+	QJsonObject result;
+	result["type"] = str.section( ':', 0, 0 );
+	const QString options = str.section( ':', 1 );
+	if( ! options.isEmpty() ) {
+		result["win32"] = false;
+		result["x64"] = false;
+		result["desktopGl"] = false;
+		result["angle"] = false;
+		result["arm"] = false;
+		const QStringList optionList = options.split( ',', QString::SkipEmptyParts );
+		for( QStringList::ConstIterator optionIt = optionList.begin(); optionIt != optionList.end(); ++optionIt )
+			result[*optionIt] = true;
+	}
+
+	return result;
+}
+
+static bool resolveCinderPath( BatchGenerator *batch )
+{
+	if( batch->getCinderPath().isEmpty() && ! Preferences::getCinderVersions().isEmpty() )
+		batch->setCinderPath( Preferences::getDefaultCinderVersion().path );
+	if( batch->getCinderPath().isEmpty() ) {
+		std::cerr << "No Cinder location given; use --cinder" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+// prints the warnings and errors of scanning and parsing the Cinder tree, ie why a CinderBlock couldn't be found
+static void reportScanErrors( const BatchGenerator &batch )
+{
+	const QList<ErrorList::Error> &messages = batch.getErrors().mMessages;
+	for( QList<ErrorList::Error>::ConstIterator msgIt = messages.begin(); msgIt != messages.end(); ++msgIt ) {
+		// the GUI's file paths are links
+		QString filePath = msgIt->mFilePath;
+		filePath.remove( QRegExp( "<[^>]*>" ) );
+		std::cerr << ( msgIt->mIsError ? "Error: " : "Warning: " ) << msgIt->mMsg.toStdString();
+		if( ! filePath.isEmpty() )
+			std::cerr << " (" << filePath.toStdString() << ")";
+		std::cerr << std::endl;
+	}
+}
+
+// prints each failure and returns how many there were
+static int reportFailures( const QList<BatchGenerator::Result> &results )
+{
+	int failed = 0;
+	for( QList<BatchGenerator::Result>::ConstIterator resultIt = results.begin(); resultIt != results.end(); ++resultIt ) {
+		if( ! resultIt->mSucceeded ) {
+			std::cerr << "Failed: " << resultIt->mName.toStdString() << ": " << resultIt->mMessage.toStdString() << std::endl;
+			++failed;
+		}
+	}
+
+	return failed;
+}
+
+static int runBatch( BatchGenerator *batch )
+{
+	if( ! resolveCinderPath( batch ) )
+		return 1;
+
+	QList<BatchGenerator::Result> results = batch->run();
+	reportScanErrors( *batch );
+	int failed = reportFailures( results );
+	CopyStats copyStats;
+	for( QList<BatchGenerator::Result>::ConstIterator resultIt = results.begin(); resultIt != results.end(); ++resultIt )
+		copyStats += resultIt->mCopyStats;
+	std::cout << ( results.size() - failed ) << " of " << results.size() << " projects generated, "
+		<< batch->getProjectsPerSecond() << " projects/sec" << std::endl;
+	std::cout << "Copied " << copyStats.mFilesCopied << " files (" << copyStats.mBytesCopied << " bytes), "
+		<< copyStats.mFilesSkipped << " already up to date" << std::endl;
+
+	return ( failed > 0 ) ? 1 : 0;
+}
+
+// writes the plans as indented JSON, so that plans from two versions of TinderBox or of a template can be diffed
+static int planBatch( BatchGenerator *batch, const QString &planPath )
+{
+	if( ! resolveCinderPath( batch ) )
+		return 1;
+
+	QJsonArray plans;
+	QList<BatchGenerator::Result> results = batch->plan( &plans );
+	reportScanErrors( *batch );
+	int failed = reportFailures( results );
+
+	QJsonObject root;
+	root["projects"] = plans;
+	QFile planFile( planPath );
+	const bool opened = ( planPath == "-" ) ? planFile.open( stdout, QIODevice::WriteOnly ) : planFile.open( QIODevice::WriteOnly );
+	if( ( ! opened ) || ( planFile.write( QJsonDocument( root ).toJson( QJsonDocument::Indented ) ) < 0 ) ) {
+		std::cerr << "Couldn't write plan: " << planPath.toStdString() << std::endl;
+		return 1;
+	}
+
+	return ( failed > 0 ) ? 1 : 0;
+}
+
+int main( int argc, char *argv[] )
+{
+	QCoreApplication app( argc, argv );
+
+	// shares the GUI's settings, ie its list of Cinder locations
+	QCoreApplication::setOrganizationName( "libcinder" );
+	QCoreApplication::setOrganizationDomain( "libcinder.org" );
+	QCoreApplication::setApplicationName( "TinderBox" );
+
+	QCommandLineParser parser;
+	parser.setApplicationDescription( "Generates Cinder projects without the TinderBox GUI." );
+	parser.addHelpOption();
+	QCommandLineOption templateOption( QStringList() << "t" << "template", "Id of the project template.", "id" );
+	QCommandLineOption nameOption( QStringList() << "n" << "name", "Name of the project.", "name" );
+	QCommandLineOption prefixOption( "prefix", "Name prefix of the project's files; defaults to the project name.", "prefix" );
+	QCommandLineOption outputOption( QStringList() << "o" << "output", "Directory the project is created in.", "dir", "." );
+	QCommandLineOption cinderOption( QStringList() << "c" << "cinder", "Cinder location; defaults to TinderBox's default.", "path" );
+	QCommandLineOption generatorOption( QStringList() << "g" << "generator",
+		"Generator, repeatable: xcode, xcode_ios, vc2015 or vc2015_uwp, optionally followed by platforms, ie vc2015:x64,angle.", "type" );
+	QCommandLineOption blockOption( QStringList() << "b" << "block", "CinderBlock, repeatable, as id[:copy|reference|git].", "block" );
+	QCommandLineOption gitOption( "git", "Create a git repository for the project." );
+	QCommandLineOption batchOption( "batch", "Generate every project of a JSON manifest; see BatchGenerator.h.", "manifest" );
+	QCommandLineOption jobsOption( QStringList() << "j" << "jobs", "Projects generated concurrently; defaults to one per core.", "count" );
+	QCommandLineOption traceOption( "trace", "Write a Chrome trace of the run to a file; also set by $TINDERBOX_TRACE.", "path" );
+	QCommandLineOption compareOption( "compare-contents", "Compare file data, not just size and mtime, before keeping an existing copy." );
+	QCommandLineOption planOption( "plan", "Write what would be generated to a JSON file instead of generating; - writes to stdout.", "path" );
+	parser.addOption( templateOption );
+	parser.addOption( nameOption );
+	parser.addOption( prefixOption );
+	parser.addOption( outputOption );
+	parser.addOption( cinderOption );
+	parser.addOption( generatorOption );
+	parser.addOption( blockOption );
+	parser.addOption( gitOption );
+	parser.addOption( batchOption );
+	parser.addOption( jobsOption );
+	parser.addOption( traceOption );
+	parser.addOption( compareOption );
+	parser.addOption( planOption );
+	parser.process( app );
+
+	if( parser.isSet( traceOption ) )
+		Trace::start( parser.value( traceOption ) );
+	else
+		Trace::startFromEnvironment();
+
+	try {
+		BatchGenerator batch;
+		if( parser.isSet( batchOption ) )
+			batch.loadManifest( parser.value( batchOption ) );
+		else {
+			if( ! parser.isSet( templateOption ) || ! parser.isSet( nameOption ) || ! parser.isSet( generatorOption ) ) {
+				std::cerr << "--template, --name and at least one --generator are required" << std::endl;
+				return 1;
+			}
+
+			BatchGenerator::Project project;
+			project.mName = parser.value( nameOption );
+			project.mNamePrefix = parser.isSet( prefixOption ) ? parser.value( prefixOption ) : project.mName;
+			project.mTemplateId = parser.value( templateOption );
+			project.mOutputDir = QDir( parser.value( outputOption ) ).absolutePath();
+			project.mSetupGit = parser.isSet( gitOption );
+			const QStringList generators = parser.values( generatorOption );
+			for( QStringList::ConstIterator genIt = generators.begin(); genIt != generators.end(); ++genIt )
+				project.mGenerators.push_back( parseGenerator( *genIt ) );
+			const QStringList blocks = parser.values( blockOption );
+			for( QStringList::ConstIterator blockIt = blocks.begin(); blockIt != blocks.end(); ++blockIt )
+				project.mBlocks.push_back( qMakePair( blockIt->section( ':', 0, 0 ), BatchGenerator::installTypeFromString( blockIt->section( ':', 1 ) ) ) );
+			batch.addProject( project );
+		}
+
+		if( parser.isSet( cinderOption ) )
+			batch.setCinderPath( QDir( parser.value( cinderOption ) ).absolutePath() );
+		if( parser.isSet( jobsOption ) )
+			batch.setJobCount( parser.value( jobsOption ).toInt() );
+		if( parser.isSet( compareOption ) )
+			batch.setCompareContents( true );
+
+		int result = parser.isSet( planOption ) ? planBatch( &batch, parser.value( planOption ) ) : runBatch( &batch );
+		Trace::finish();
+		return result;
+	}
+	catch( const TinderBoxExc &exc ) {
+		std::cerr << exc.msg().toStdString() << std::endl;
+		Trace::finish();
+		return 1;
+	}
+}
@@ -22,25 +22,25 @@
 */
 
 #include "VcProj.h"
+#include "Trace.h"
 #include "Util.h"
 #include <QUuid>
 
 VcProj::VcProj( const QString &vcProjString, const QString &vcProjFiltersString )
 {
-	// .vcxproj
+	TBOX_TRACE_SCOPE( "VcProj::VcProj" );
+	// .vcxproj; pugixml converts QString's UTF-16 straight into its own buffer, rather than via a std::string copy
 	mProjDom = QSharedPointer<pugi::xml_document>( new pugi::xml_document() );
-	std::string vcProjStdStr = vcProjString.toStdString();
-	pugi::xml_parse_result result = mProjDom->load_buffer( vcProjStdStr.c_str(), vcProjStdStr.length() );
+	pugi::xml_parse_result result = mProjDom->load_buffer( vcProjString.utf16(), vcProjString.size() * sizeof( ushort ), pugi::parse_default, pugi::encoding_utf16 );
 	if( ! result ) {
-		throw VcProjExc( "Failed to parse VcProj" );
+		throw VcProjExc( "Failed to parse VcProj: " + QString( result.description() ) + QString( " (offset %1)" ).arg( (qint64)result.offset ) );
 	}
 
 	// .vcxproj.filters
 	QSharedPointer<pugi::xml_document> projFiltersDom( new pugi::xml_document() );
-	std::string vcProjFiltersStdStr = vcProjFiltersString.toStdString();
-	result = projFiltersDom->load_buffer( vcProjFiltersStdStr.c_str(), vcProjFiltersStdStr.length() );
+	result = projFiltersDom->load_buffer( vcProjFiltersString.utf16(), vcProjFiltersString.size() * sizeof( ushort ), pugi::parse_default, pugi::encoding_utf16 );
 	if( ! result ) {
-		throw VcProjExc( "Failed to parse VcProj filters" );
+		throw VcProjExc( "Failed to parse VcProj filters: " + QString( result.description() ) + QString( " (offset %1)" ).arg( (qint64)result.offset ) );
 	}
 	mFilters = QSharedPointer<Filters>( new Filters( projFiltersDom ) );
 }
@@ -402,6 +402,7 @@ QString VcProj::getRcString() const
 
 void VcProj::write( const QString &directoryPath, const QString &namePrefix ) const
 {
+	TBOX_TRACE_SCOPE( "VcProj::write" );
 	QDir dir( directoryPath );
 
 	if( ! mResourcesHeaderPath.isEmpty() ) {
@@ -22,6 +22,7 @@
 */
 
 #include "XCodeProj.h"
+#include "Trace.h"
 
 #include <iostream>
 #include <algorithm>
@@ -138,6 +139,7 @@ XCodeProj::XCodeProj( QSharedPointer<PList> plist )
 
 XCodeProjRef XCodeProj::createFromFilePath( QString path )
 {
+	TBOX_TRACE_SCOPE( "XCodeProj::createFromFilePath" );
 	QFile qf( path );
 	QSharedPointer<PList> plist( PList::create( qf ) );
 	return QSharedPointer<XCodeProj>( new XCodeProj( plist ) );
@@ -145,6 +147,7 @@ XCodeProjRef XCodeProj::createFromFilePath( QString path )
 
 XCodeProjRef XCodeProj::createFromString( const QString &s )
 {
+	TBOX_TRACE_SCOPE( "XCodeProj::createFromString" );
 	QSharedPointer<PList> plist( PList::create( s ) );
 	return QSharedPointer<XCodeProj>( new XCodeProj( plist ) );
 }
@@ -196,6 +199,7 @@ QSharedPointer<XCodeProj::PbxItem>	XCodeProj::findItemGeneric( const QString &ta
 
 void XCodeProj::print( std::ostream &os )
 {
+	TBOX_TRACE_SCOPE( "XCodeProj::print" );
 	mPList->print( os );
 }
 
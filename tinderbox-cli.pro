@@ -0,0 +1,95 @@
+#-------------------------------------------------
+#
+# Headless command-line generator; shares everything but the GUI with TinderBox.pro
+#
+#-------------------------------------------------
+
+QT       += core xml concurrent
+QT       -= gui
+
+TARGET = tinderbox-cli
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+INCLUDEPATH += src/ src/parse/
+
+win32 {
+    CONFIG += C++11
+}
+
+linux {
+    QMAKE_CXXFLAGS += -std=c++11 -D_GLIBCXX_USE_CXX11_ABI=0
+}
+
+SOURCES += \
+    src/BatchGenerator.cpp \
+    src/CinderBlock.cpp \
+    src/CinderBlockManager.cpp \
+    src/CompiledTemplate.cpp \
+    src/CopyPlan.cpp \
+    src/DirListingCache.cpp \
+    src/ErrorList.cpp \
+    src/GenerationPlan.cpp \
+    src/GeneratorVc2015.cpp \
+    src/GeneratorVcBase.cpp \
+    src/GeneratorXcodeBase.cpp \
+    src/GeneratorXcodeIos.cpp \
+    src/GeneratorXcodeMac.cpp \
+    src/Instancer.cpp \
+    src/mainCli.cpp \
+    src/Preferences.cpp \
+    src/ProjectTemplate.cpp \
+    src/ProjectTemplateManager.cpp \
+    src/StringPool.cpp \
+    src/Template.cpp \
+    src/TemplateCache.cpp \
+    src/TemplateStream.cpp \
+    src/TokenReplacer.cpp \
+    src/Trace.cpp \
+    src/Util.cpp \
+    src/XmlFile.cpp \
+    src/parse/PList.cpp \
+    src/parse/Vc2015WinRtProj.cpp \
+    src/parse/Vc2015Proj.cpp \
+    src/parse/VcProj.cpp \
+    src/parse/XCodeProj.cpp \
+    src/pugixml/pugixml.cpp \
+    src/GeneratorVc2015Winrt.cpp
+
+HEADERS  += \
+    src/BatchGenerator.h \
+    src/CinderBlock.h \
+    src/CinderBlockManager.h \
+    src/CompiledTemplate.h \
+    src/CopyPlan.h \
+    src/DirListingCache.h \
+    src/ErrorList.h \
+    src/GenerationPlan.h \
+    src/GeneratorBase.h \
+    src/GeneratorVc2015Winrt.h \
+    src/GeneratorVc2015.h \
+    src/GeneratorVcBase.h \
+    src/GeneratorXcodeBase.h \
+    src/GeneratorXcodeIos.h \
+    src/GeneratorXcodeMac.h \
+    src/Instancer.h \
+    src/Preferences.h \
+    src/ProjectTemplate.h \
+    src/ProjectTemplateManager.h \
+    src/StringPool.h \
+    src/Template.h \
+    src/TemplateCache.h \
+    src/TemplateStream.h \
+    src/TinderBox.h \
+    src/TokenReplacer.h \
+    src/Trace.h \
+    src/Util.h \
+    src/XmlFile.h \
+    src/parse/PList.h \
+    src/parse/Vc2015WinRtProj.h \
+    src/parse/Vc2015Proj.h \
+    src/parse/VcProj.h \
+    src/parse/XCodeProj.h \
+    src/pugixml/pugiconfig.hpp \
+    src/pugixml/pugixml.hpp